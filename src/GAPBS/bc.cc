@@ -0,0 +1,165 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#include "bc.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: Betweenness Centrality (BC)
+Author: Scott Beamer
+
+Will return array of approx betweenness centrality scores for each vertex
+
+This BC implementation makes use of the Brandes [1] algorithm with
+implementation optimizations from Madduri et al. [2]. It is only approximate
+because it does not compute the paths from every start vertex, but only a small
+subset of them. Additionally, the scores are normalized to the range [0,1].
+
+As an optimization to save memory, this implementation uses a Bitmap to hold
+succ (list of successors) found during the BFS phase that are used in the back-
+propagation phase. The bits are indexed by edge positions in a CSR snapshot of
+the graph (BuildCSRGraph), which is taken once and shared by all sources.
+
+[1] Ulrik Brandes. "A faster algorithm for betweenness centrality." Journal of
+    Mathematical Sociology, 25(2):163–177, 2001.
+
+[2] Kamesh Madduri, David Ediger, Karl Jiang, David A Bader, and Daniel
+    Chavarria-Miranda. "A faster parallel algorithm and efficient multithreaded
+    implementations for evaluating betweenness centrality on massive datasets."
+    International Symposium on Parallel & Distributed Processing (IPDPS), 2009.
+*/
+
+CSRGraph BuildCSRGraph(RadixGraph* g, uint32_t num_nodes) {
+  CSRGraph csr;
+  // Pass 1: count neighbours; pass 2: fill them
+  csr.offsets.assign(num_nodes + 1, 0);
+  #pragma omp parallel
+  {
+    std::vector<WeightedEdge> neighbours;
+    #pragma omp for schedule(dynamic, 256)
+    for (NodeID n = 0; n < num_nodes; n++) {
+      g->GetNeighboursByOffset(n, neighbours);
+      csr.offsets[n + 1] = neighbours.size();
+    }
+  }
+  for (NodeID n = 0; n < num_nodes; n++) csr.offsets[n + 1] += csr.offsets[n];
+  csr.neighbours.resize(csr.offsets[num_nodes]);
+  #pragma omp parallel
+  {
+    std::vector<WeightedEdge> neighbours;
+    #pragma omp for schedule(dynamic, 256)
+    for (NodeID n = 0; n < num_nodes; n++) {
+      g->GetNeighboursByOffset(n, neighbours);
+      int64_t begin = csr.offsets[n], cnt = 0;
+      for (auto e : neighbours) {
+        // Edges inserted after pass 1 are ignored; removed ones leave self loops,
+        // which never join a shortest path
+        if (begin + cnt < csr.offsets[n + 1] && (int)e.idx < (int)num_nodes) csr.neighbours[begin + cnt++] = e.idx;
+      }
+      std::fill(csr.neighbours.begin() + begin + cnt, csr.neighbours.begin() + csr.offsets[n + 1], (int)n);
+    }
+  }
+  return csr;
+}
+
+static void PBFS(const CSRGraph &g, int source, pvector<CountT> &path_counts,
+                 Bitmap &succ, std::vector<SlidingQueue<int>::iterator> &depth_index,
+                 SlidingQueue<int> &queue, pvector<int> &depths) {
+  depths.fill(-1);
+  depths[source] = 0;
+  path_counts[source] = 1;
+  queue.push_back(source);
+  depth_index.push_back(queue.begin());
+  queue.slide_window();
+  #pragma omp parallel
+  {
+    int depth = 0;
+    QueueBuffer<int> lqueue(queue);
+    while (!queue.empty()) {
+      depth++;
+      #pragma omp for schedule(dynamic, 64) nowait
+      for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
+        int u = *q_iter;
+        for (int64_t i = g.offsets[u]; i < g.offsets[u + 1]; i++) {
+          int v = g.neighbours[i];
+          if ((depths[v] == -1) &&
+              (compare_and_swap(depths[v], -1, depth))) {
+            lqueue.push_back(v);
+          }
+          if (depths[v] == depth) {
+            succ.set_bit_atomic(i);
+            #pragma omp atomic
+            path_counts[v] += path_counts[u];
+          }
+        }
+      }
+      lqueue.flush();
+      #pragma omp barrier
+      #pragma omp single
+      {
+        depth_index.push_back(queue.begin());
+        queue.slide_window();
+      }
+    }
+  }
+  depth_index.push_back(queue.begin());
+}
+
+pvector<ScoreT> Brandes(RadixGraph* g, uint32_t num_nodes, const std::vector<int>& sources) {
+  CSRGraph csr = BuildCSRGraph(g, num_nodes);
+  pvector<ScoreT> scores(num_nodes, 0);
+  pvector<CountT> path_counts(num_nodes);
+  pvector<int> depths(num_nodes);
+  pvector<ScoreT> deltas(num_nodes);
+  Bitmap succ(std::max<size_t>(csr.neighbours.size(), 1));
+  std::vector<SlidingQueue<int>::iterator> depth_index;
+  SlidingQueue<int> queue(num_nodes);
+  for (int source : sources) {
+    path_counts.fill(0);
+    depth_index.resize(0);
+    queue.reset();
+    succ.reset();
+    PBFS(csr, source, path_counts, succ, depth_index, queue, depths);
+    deltas.fill(0);
+    for (int d = depth_index.size() - 2; d >= 0; d--) {
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (auto it = depth_index[d]; it < depth_index[d + 1]; it++) {
+        int u = *it;
+        ScoreT delta_u = 0;
+        for (int64_t i = csr.offsets[u]; i < csr.offsets[u + 1]; i++) {
+          if (succ.get_bit(i)) {
+            int v = csr.neighbours[i];
+            delta_u += (path_counts[u] / path_counts[v]) * (1 + deltas[v]);
+          }
+        }
+        deltas[u] = delta_u;
+        scores[u] += delta_u;
+      }
+    }
+  }
+  // normalize scores
+  ScoreT biggest_score = 0;
+  #pragma omp parallel for reduction(max : biggest_score)
+  for (NodeID n = 0; n < num_nodes; n++)
+    biggest_score = std::max(biggest_score, scores[n]);
+  if (biggest_score > 0) {
+    #pragma omp parallel for
+    for (NodeID n = 0; n < num_nodes; n++)
+      scores[n] = scores[n] / biggest_score;
+  }
+  return scores;
+}
+
+pvector<ScoreT> Brandes(RadixGraph* g, uint32_t num_nodes, int num_sources, unsigned seed) {
+  if (num_nodes == 0) return pvector<ScoreT>();
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> distribution(0, num_nodes - 1);
+  std::vector<int> sources;
+  // Like GAPBS' SourcePicker, skip vertices without edges (bounded tries on near-empty graphs)
+  for (int64_t tries = 0; (int)sources.size() < num_sources && tries < 64ll * num_sources + num_nodes; tries++) {
+    int source = distribution(rng);
+    if (g->degree[source] > 0) sources.push_back(source);
+  }
+  return Brandes(g, num_nodes, sources);
+}
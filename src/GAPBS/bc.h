@@ -0,0 +1,33 @@
+//
+// Betweenness centrality with Brandes' algorithm
+//
+
+#ifndef GRAPHINDEX_BC_H
+#define GRAPHINDEX_BC_H
+
+#include "benchmark.h"
+#include "bitmap.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+#include "sliding_queue.h"
+#include "../radixgraph.h"
+
+typedef float ScoreT;
+typedef double CountT;
+
+// Snapshot of the out-neighbour lists in CSR form, so that every edge has a
+// position that can index a bitmap
+struct CSRGraph {
+  std::vector<int64_t> offsets;
+  std::vector<int> neighbours;
+};
+
+CSRGraph BuildCSRGraph(RadixGraph* g, uint32_t num_nodes);
+
+// Approximate BC from num_sources sources picked at random among vertices with
+// edges; scores are indexed by offset and normalized to a maximum of 1
+pvector<ScoreT> Brandes(RadixGraph* g, uint32_t num_nodes, int num_sources, unsigned seed = 27491095);
+// Same as above, from the given source offsets
+pvector<ScoreT> Brandes(RadixGraph* g, uint32_t num_nodes, const std::vector<int>& sources);
+
+#endif //GRAPHINDEX_BC_H
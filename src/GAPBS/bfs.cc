@@ -118,16 +118,20 @@ pvector<NodeID> DOBFS(RadixGraph* g, NodeID source, int vertex_num, int edge_num
     if (src_out_degree == -1) src_out_degree = u->deg;
     pvector<NodeID> parent = InitParent(g, vertex_num);
     parent[uidx] = uidx;
+    DOBFSFrom(g, parent, std::vector<int>{uidx}, vertex_num, edge_num, src_out_degree, alpha, beta);
+    return parent;
+}
 
+void DOBFSFrom(RadixGraph* g, pvector<NodeID> &parent, const std::vector<int> &frontier, int vertex_num,
+               int64_t edge_num, int64_t scout_count, int alpha, int beta) {
     SlidingQueue<int> queue(vertex_num);
-    queue.push_back(uidx);
+    for (int u : frontier) queue.push_back(u);
     queue.slide_window();
     Bitmap curr(vertex_num);
     curr.reset();
     Bitmap front(vertex_num);
     front.reset();
     int64_t edges_to_check = edge_num;
-    int64_t scout_count = src_out_degree;
     while (!queue.empty()) {
         // edit for only top-down search
         if (scout_count > edges_to_check / alpha) {
@@ -149,5 +153,4 @@ pvector<NodeID> DOBFS(RadixGraph* g, NodeID source, int vertex_num, int edge_num
             queue.slide_window();
         }
     }
-    return parent;
 }
\ No newline at end of file
@@ -18,5 +18,9 @@ extern void BitmapToQueue(RadixGraph* g, int vertex_num, const Bitmap &bm,
 extern pvector<NodeID> InitParent(RadixGraph* g, int vertex_num);
 extern pvector<NodeID> DOBFS(RadixGraph* g, NodeID source, int vertex_num, int edge_num, int src_out_degree, int alpha = 15,
                       int beta = 18);
+// Continues a search whose visited vertices are already marked in parent, from the
+// given frontier; scout_count is the sum of the out-degrees of the frontier
+extern void DOBFSFrom(RadixGraph* g, pvector<NodeID> &parent, const std::vector<int> &frontier, int vertex_num,
+                      int64_t edge_num, int64_t scout_count, int alpha = 15, int beta = 18);
 
 #endif //GRAPHINDEX_BFS_H
@@ -0,0 +1,120 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#include "cc_afforest.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: Connected Components (CC)
+Authors: Michael Sutton, Scott Beamer
+
+Will return comp array labelling each vertex with a connected component ID
+
+This CC implementation makes use of the Afforest subgraph sampling algorithm [1],
+which restructures and extends the Shiloach-Vishkin algorithm [2].
+
+In the sampling rounds, each vertex is linked with its r-th neighbour only.
+Neighbours are read with GetNeighbourByOffset, which indexes the edge log
+directly (without materializing the neighbour list) for vertices whose log has
+no updates or deletions. The largest intermediate component is then identified
+by sampling, and its vertices are skipped in the final pass over the remaining
+neighbours. Skipping is only correct for symmetric graphs, as edges pointing
+into the giant component would otherwise be missed (in-edges are not indexed).
+
+Like ShiloachVishkin, every component ends up labelled by its smallest offset.
+
+[1] Michael Sutton, Tal Ben-Nun, and Amnon Barak. "Optimizing Parallel
+    Graph Connectivity Computation via Subgraph Sampling" Symposium on
+    Parallel and Distributed Processing, IPDPS 2018.
+
+[2] Yossi Shiloach and Uzi Vishkin. "An o(logn) parallel connectivity algorithm"
+    Journal of Algorithms, 3(1):57–67, 1982.
+*/
+// Place nodes u and v in same component of lower component ID
+void Link(NodeID u, NodeID v, pvector<NodeID>& comp) {
+  NodeID p1 = comp[u];
+  NodeID p2 = comp[v];
+  while (p1 != p2) {
+    NodeID high = p1 > p2 ? p1 : p2;
+    NodeID low = p1 + (p2 - high);
+    NodeID p_high = comp[high];
+    // Was already 'low' or succeeded in writing 'low'
+    if ((p_high == low) ||
+        (p_high == high && compare_and_swap(comp[high], high, low)))
+      break;
+    p1 = comp[comp[high]];
+    p2 = comp[low];
+  }
+}
+
+// Reduce depth of tree for each component to 1 by crawling up parents
+void Compress(uint32_t num_nodes, pvector<NodeID>& comp) {
+  #pragma omp parallel for schedule(dynamic, 16384)
+  for (NodeID n = 0; n < num_nodes; n++) {
+    while (comp[n] != comp[comp[n]]) {
+      comp[n] = comp[comp[n]];
+    }
+  }
+}
+
+NodeID SampleFrequentElement(const pvector<NodeID>& comp, int64_t num_samples) {
+  std::unordered_map<NodeID, int> sample_counts(32);
+  using kvp_type = std::unordered_map<NodeID, int>::value_type;
+  // Sample elements from 'comp'
+  std::mt19937 gen;
+  std::uniform_int_distribution<NodeID> distribution(0, comp.size() - 1);
+  for (NodeID i = 0; i < num_samples; i++) {
+    NodeID n = distribution(gen);
+    sample_counts[comp[n]]++;
+  }
+  // Find most frequent element in samples (estimate of most frequent overall)
+  auto most_frequent = std::max_element(
+    sample_counts.begin(), sample_counts.end(),
+    [](const kvp_type& a, const kvp_type& b) { return a.second < b.second; });
+  return most_frequent->first;
+}
+
+pvector<NodeID> Afforest(RadixGraph* g, uint32_t num_nodes, bool directed,
+                         int32_t neighbor_rounds) {
+  pvector<NodeID> comp(num_nodes);
+  if (num_nodes == 0) return comp;
+
+  // Initialize each node to a single-node self-pointing tree
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_nodes; n++)
+    comp[n] = n;
+
+  // Process a sparse sampled subgraph first for approximating components.
+  // Sample by processing a fixed number of neighbors for each node (see paper)
+  for (int r = 0; r < neighbor_rounds; ++r) {
+    #pragma omp parallel for schedule(dynamic, 16384)
+    for (NodeID u = 0; u < num_nodes; u++) {
+      WeightedEdge e;
+      if (g->GetNeighbourByOffset(u, r, e)) Link(u, e.idx, comp);
+    }
+    Compress(num_nodes, comp);
+  }
+
+  // Sample 'comp' to find the most frequent element -- due to prior
+  // compression, this value represents the largest intermediate component
+  NodeID c = directed ? num_nodes : SampleFrequentElement(comp);
+
+  // Final 'link' phase over remaining edges (excluding largest component)
+  #pragma omp parallel
+  {
+    std::vector<WeightedEdge> neighbours;
+    #pragma omp for schedule(dynamic, 16384)
+    for (NodeID u = 0; u < num_nodes; u++) {
+      // Skip processing nodes in the largest component
+      if (comp[u] == c) continue;
+      // Skip over part of neighborhood (determined by neighbor_rounds)
+      g->GetNeighboursByOffset(u, neighbours);
+      for (size_t i = neighbor_rounds; i < neighbours.size(); i++)
+        Link(u, neighbours[i].idx, comp);
+    }
+  }
+  // Finally, 'compress' for final convergence
+  Compress(num_nodes, comp);
+  return comp;
+}
@@ -0,0 +1,22 @@
+//
+// Weakly connected components with Afforest
+//
+
+#ifndef GRAPHINDEX_CC_AFFOREST_H
+#define GRAPHINDEX_CC_AFFOREST_H
+
+#include "benchmark.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+#include "../radixgraph.h"
+
+void Link(NodeID u, NodeID v, pvector<NodeID>& comp);
+void Compress(uint32_t num_nodes, pvector<NodeID>& comp);
+NodeID SampleFrequentElement(const pvector<NodeID>& comp, int64_t num_samples = 1024);
+// directed: whether the graph may be non-symmetric; the giant component cannot be
+// skipped in the final pass then, since in-edges are not indexed. Callers with a
+// non-symmetric graph must pass true.
+pvector<NodeID> Afforest(RadixGraph* g, uint32_t num_nodes, bool directed = false,
+                         int32_t neighbor_rounds = 2);
+
+#endif //GRAPHINDEX_CC_AFFOREST_H
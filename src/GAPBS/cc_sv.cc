@@ -30,38 +30,48 @@ more consistent performance for undirected graphs.
 // The hooking condition (comp_u < comp_v) may not coincide with the edge's
 // direction, so we use a min-max swap such that lower component IDs propagate
 // independent of the edge's direction.
+namespace {
+
+// Hooks the higher of the two components of an edge onto the lower one
+struct SVHook {
+  pvector<NodeID>& comp;
+
+  bool update(int u, int v, EdgeWeight w) { return updateAtomic(u, v, w); }
+  bool updateAtomic(int u, int v, EdgeWeight) {
+    NodeID comp_u = comp[u];
+    NodeID comp_v = comp[v];
+    if (comp_u == comp_v) return false;
+    // Hooking condition so lower component ID wins independent of direction
+    NodeID high_comp = comp_u > comp_v ? comp_u : comp_v;
+    NodeID low_comp = comp_u + (comp_v - high_comp);
+    if (high_comp == comp[high_comp]) {
+      comp[high_comp] = low_comp;
+      return true;
+    }
+    return false;
+  }
+  bool cond(int) { return true; }
+};
+
+}  // namespace
+
 pvector<NodeID> ShiloachVishkin(RadixGraph* g, uint32_t num_nodes) {
   pvector<NodeID> comp(num_nodes);
   #pragma omp parallel for
   for (NodeID n=0; n < num_nodes; n++) comp[n] = n;
+  SVHook hook{comp};
   bool change = true;
   int num_iter = 0;
   while (change) {
-    change = false;
     num_iter++;
-    #pragma omp parallel for
-    for (NodeID n=0; n < num_nodes; n++) {
-      std::vector<WeightedEdge> neighbours;
-      g->GetNeighboursByOffset(n, neighbours);
-      for (auto e : neighbours) {
-        NodeID comp_u = comp[n];
-        NodeID comp_v = comp[e.idx];
-        if (comp_u == comp_v) continue;
-        // Hooking condition so lower component ID wins independent of direction
-        NodeID high_comp = comp_u > comp_v ? comp_u : comp_v;
-        NodeID low_comp = comp_u + (comp_v - high_comp);
-        if (high_comp == comp[high_comp]) {
-          change = true;
-          comp[high_comp] = low_comp;
-        }
-      }
-    }
-    #pragma omp parallel for
-    for (NodeID n=0; n < num_nodes; n++) {
+    // Every round hooks along all edges, so the push is forced dense
+    VertexSubset all = VertexSubset::All(num_nodes);
+    change = !EdgeMap(g, all, hook, 0, false, 0).empty();
+    VertexMap(all, [&](int n) {
       while (comp[n] != comp[comp[n]]) {
         comp[n] = comp[comp[n]];
       }
-    }
+    });
   }
   return comp;
-}
\ No newline at end of file
+}
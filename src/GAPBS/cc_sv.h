@@ -8,6 +8,7 @@
 
 #include "benchmark.h"
 #include "bitmap.h"
+#include "ligra.h"
 #include "pvector.h"
 #include "../radixgraph.h"
 
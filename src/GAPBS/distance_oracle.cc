@@ -0,0 +1,119 @@
+#include "distance_oracle.h"
+
+/*
+Landmark distance oracle
+
+For every vertex v and landmark l, d(l, v) and d(v, l) are stored next to each
+other for all landmarks of v, so a query reads two short rows. By the triangle
+inequality, for every landmark l:
+  d(s, t) <= d(s, l) + d(l, t)
+  d(s, t) >= d(l, t) - d(l, s)  and  d(s, t) >= d(s, l) - d(t, l)
+Unweighted distances of all landmarks come from a single MultiSourceBFS pass,
+weighted ones from one DeltaStep per landmark.
+*/
+
+DistanceOracle::DistanceOracle(RadixGraph* g, int num_landmarks, RadixGraph* reverse,
+                               int refresh_after, bool weighted, WeightT delta)
+    : g_(g), reverse_(reverse), num_landmarks_(num_landmarks), refresh_after_(refresh_after),
+      weighted_(weighted), delta_(delta) {
+#ifdef RG_UNWEIGHTED
+  weighted_ = false;
+#endif
+  Build();
+}
+
+void DistanceOracle::ComputeDistances(RadixGraph* h, const std::vector<NodeID>& sources, std::vector<float>& dist) {
+  uint32_t num_nodes = h->vertex_index->cnt;
+  int k = landmarks_.size();
+  // Offsets of h mapped to offsets of g_ (identity for g_ itself)
+  std::vector<int> to_g(num_nodes);
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_nodes; n++) {
+    if (h == g_) {
+      to_g[n] = n < num_nodes_ ? n : -1;
+      continue;
+    }
+    auto v = g_->vertex_index->RetrieveVertex(h->vertex_index->vertex_table[n].node);
+    to_g[n] = v != nullptr && v->idx >= 0 && v->idx < (int)num_nodes_ ? v->idx : -1;
+  }
+  dist.assign((size_t)num_nodes_ * k, INFINITY);
+  if (!weighted_) {
+    auto hops = MultiSourceBFS(h, sources, num_nodes);
+    #pragma omp parallel for
+    for (NodeID n = 0; n < num_nodes; n++) {
+      if (to_g[n] == -1) continue;
+      for (int l = 0; l < k; l++) {
+        if (hops[l][n] != -1) dist[(size_t)to_g[n] * k + l] = hops[l][n];
+      }
+    }
+    return;
+  }
+  long num_edges = 1;
+  #pragma omp parallel for reduction(+:num_edges)
+  for (NodeID n = 0; n < num_nodes; n++) num_edges += h->vertex_index->vertex_table[n].deg;
+  for (int l = 0; l < k; l++) {
+    auto res = DeltaStep(h, sources[l], delta_, num_nodes, num_edges);
+    #pragma omp parallel for
+    for (NodeID n = 0; n < num_nodes; n++) {
+      if (to_g[n] != -1 && res[n] < std::numeric_limits<WeightT>::max() / 4) dist[(size_t)to_g[n] * k + l] = res[n];
+    }
+  }
+}
+
+void DistanceOracle::Build() {
+  num_nodes_ = g_->vertex_index->cnt;
+  std::vector<int> order(num_nodes_);
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_nodes_; n++) order[n] = n;
+  int k = std::min<int>(num_landmarks_, num_nodes_);
+  std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](int a, int b) {
+    int da = g_->vertex_index->vertex_table[a].deg, db = g_->vertex_index->vertex_table[b].deg;
+    return da != db ? da > db : a < b;
+  });
+  landmarks_.assign(order.begin(), order.begin() + k);
+  std::vector<NodeID> sources;
+  for (int l : landmarks_) sources.push_back(g_->vertex_index->vertex_table[l].node);
+  ComputeDistances(g_, sources, from_);
+  if (reverse_ == nullptr) to_ = from_;
+  else ComputeDistances(reverse_, sources, to_);
+  pending_ = 0;
+}
+
+void DistanceOracle::Notify(int num_updates) {
+  pending_ += num_updates;
+}
+
+void DistanceOracle::Refresh() {
+  std::unique_lock<std::shared_mutex> lock(mtx_);
+  Build();
+}
+
+std::pair<double, double> DistanceOracle::Bounds(NodeID s, NodeID t) {
+  if (pending_ >= refresh_after_) {
+    std::unique_lock<std::shared_mutex> lock(mtx_);
+    // Another query may have refreshed meanwhile
+    if (pending_ >= refresh_after_) Build();
+  }
+  std::shared_lock<std::shared_mutex> lock(mtx_);
+  auto s_ptr = g_->vertex_index->RetrieveVertex(s), t_ptr = g_->vertex_index->RetrieveVertex(t);
+  if (s_ptr == nullptr || t_ptr == nullptr || s_ptr->idx < 0 || t_ptr->idx < 0) return {0, 1e9};
+  int u = s_ptr->idx, v = t_ptr->idx;
+  if (u == v) return {0, 0};
+  // Vertices added since the last refresh have no landmark distances yet
+  if (u >= (int)num_nodes_ || v >= (int)num_nodes_) return {0, 1e9};
+  int k = landmarks_.size();
+  const float *s_from = &from_[(size_t)u * k], *s_to = &to_[(size_t)u * k];
+  const float *t_from = &from_[(size_t)v * k], *t_to = &to_[(size_t)v * k];
+  float lower = 0, upper = INFINITY;
+  for (int l = 0; l < k; l++) {
+    upper = std::min(upper, s_to[l] + t_from[l]);
+    // Also holds with infinities: if l reaches s but not t, or t reaches l but s does not, t is unreachable from s
+    if (s_from[l] != INFINITY) lower = std::max(lower, t_from[l] - s_from[l]);
+    if (t_to[l] != INFINITY) lower = std::max(lower, s_to[l] - t_to[l]);
+  }
+  return {lower == INFINITY ? 1e9 : lower, upper == INFINITY ? 1e9 : upper};
+}
+
+double DistanceOracle::Distance(NodeID s, NodeID t) {
+  return Bounds(s, t).second;
+}
@@ -0,0 +1,56 @@
+//
+// Landmark-based distance oracle
+//
+
+#ifndef GRAPHINDEX_DISTANCE_ORACLE_H
+#define GRAPHINDEX_DISTANCE_ORACLE_H
+
+#include <shared_mutex>
+
+#include "benchmark.h"
+#include "msbfs.h"
+#include "sssp.h"
+#include "../radixgraph.h"
+
+// Approximate distances from the exact distances between every vertex and a
+// few landmarks (the vertices of highest degree). Distances follow out-edges;
+// reverse is a RadixGraph holding every edge reversed (nullptr if the graph is
+// symmetric), from which the distances to the landmarks are computed. Weighted
+// mode uses DeltaStep with the given delta, unweighted mode counts hops.
+// After updating edges, Notify() the oracle (safe to call concurrently); it
+// recomputes the landmark distances on the first query after refresh_after
+// notified updates, and serves possibly stale bounds until then.
+class DistanceOracle {
+ public:
+  DistanceOracle(RadixGraph* g, int num_landmarks = 16, RadixGraph* reverse = nullptr,
+                 int refresh_after = 1024, bool weighted = false, WeightT delta = 2.0);
+
+  // Lower and upper bounds on the distance between two vertex IDs by the
+  // triangle inequality; the upper bound is 1e9 if no landmark connects them
+  std::pair<double, double> Bounds(NodeID s, NodeID t);
+  // The upper bound above, which is exact if s or t is a landmark
+  double Distance(NodeID s, NodeID t);
+  void Notify(int num_updates = 1);
+  void Refresh();
+  const std::vector<int>& Landmarks() const { return landmarks_; }
+
+ private:
+  RadixGraph* g_;
+  RadixGraph* reverse_;
+  int num_landmarks_;
+  int refresh_after_;
+  bool weighted_;
+  WeightT delta_;
+  uint32_t num_nodes_ = 0;
+  std::atomic<int> pending_ = 0;
+  std::shared_mutex mtx_;
+  // Landmark offsets, and distances from / to them by [vertex offset * k + landmark] (infinite if unreachable)
+  std::vector<int> landmarks_;
+  std::vector<float> from_, to_;
+
+  void Build();
+  // Distances from the landmarks (given as vertex IDs) in graph h, by offsets of g_
+  void ComputeDistances(RadixGraph* h, const std::vector<NodeID>& sources, std::vector<float>& dist);
+};
+
+#endif //GRAPHINDEX_DISTANCE_ORACLE_H
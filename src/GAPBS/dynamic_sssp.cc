@@ -0,0 +1,142 @@
+#include "dynamic_sssp.h"
+
+/*
+Kernel: dynamic single-source shortest paths
+
+Repairs distances after a batch of updates in the style of Ramalingam and
+Reps [1], touching only the region whose distances may change:
+  - A tree edge (parent[v], v) that was deleted or re-weighted invalidates the
+    subtree of v. The subtree is collected through the parent pointers, reset,
+    and every vertex in it restarts from its best in-neighbour outside.
+  - An inserted edge (u, v) can only lower distances, so u is queued to relax
+    its out-edges again.
+A Dijkstra search seeded with these vertices then settles everything that
+changed. Vertices outside the invalidated subtrees keep valid paths, so the
+search never has to look at them unless their distance drops.
+
+[1] G. Ramalingam and Thomas Reps. "An Incremental Algorithm for a
+    Generalization of the Shortest-Path Problem" Journal of Algorithms,
+    21(2):267-305, 1996.
+*/
+DynamicSSSP::DynamicSSSP(RadixGraph* g, NodeID source, RadixGraph* reverse, bool unweighted)
+    : g_(g), reverse_(reverse), source_(source), unweighted_(unweighted) {
+#ifdef RG_UNWEIGHTED
+  unweighted_ = true;
+#endif
+  Update({});
+}
+
+void DynamicSSSP::Grow() {
+  size_t num_nodes = g_->vertex_index->cnt, old_size = dist.size();
+  if (old_size >= num_nodes) return;
+  dist.resize(num_nodes);
+  parent.resize(num_nodes);
+  for (size_t n = old_size; n < num_nodes; n++) {
+    dist[n] = kDistInf;
+    parent[n] = -1;
+  }
+  marked_.resize(num_nodes, 0);
+}
+
+// In-edges of v, as edges to offsets of g_
+void DynamicSSSP::InNeighbours(int v) {
+  if (reverse_ == nullptr) {
+    g_->GetNeighboursByOffset(v, neighbours_);
+    return;
+  }
+  neighbours_.clear();
+  auto r = reverse_->vertex_index->RetrieveVertex(g_->vertex_index->vertex_table[v].node);
+  if (r == nullptr || r->idx < 0) return;
+  reverse_->GetNeighboursByOffset(r->idx, neighbours_);
+  int cnt = 0;
+  for (auto e : neighbours_) {
+    auto u = g_->vertex_index->RetrieveVertex(reverse_->vertex_index->vertex_table[e.idx].node);
+    if (u == nullptr || u->idx < 0) continue;
+    neighbours_[cnt] = e;
+    neighbours_[cnt++].idx = u->idx;
+  }
+  neighbours_.resize(cnt);
+}
+
+int64_t DynamicSSSP::Propagate() {
+  int64_t lowered = 0;
+  while (!queue_.empty()) {
+    auto [d, u] = queue_.top();
+    queue_.pop();
+    // Skip stale entries, including those queued before u was reset
+    if (d != dist[u]) continue;
+    g_->GetNeighboursByOffset(u, neighbours_);
+    for (auto e : neighbours_) {
+      int v = e.idx;
+      if (v >= (int)dist.size()) continue;
+      WeightT new_dist = d + (unweighted_ ? 1 : e.weight);
+      if (new_dist < dist[v]) {
+        dist[v] = new_dist;
+        parent[v] = u;
+        queue_.push({new_dist, v});
+        lowered++;
+      }
+    }
+  }
+  return lowered;
+}
+
+int64_t DynamicSSSP::Update(const std::vector<EdgeUpdate>& batch) {
+  Grow();
+  if (source_idx_ < 0) {
+    auto s = g_->vertex_index->RetrieveVertex(source_);
+    if (s == nullptr || s->idx < 0) return 0;
+    source_idx_ = s->idx;
+    dist[source_idx_] = 0;
+    parent[source_idx_] = source_idx_;
+    queue_.push({0, source_idx_});
+  }
+
+  // Roots of invalidated subtrees, and sources of new edges
+  stack_.clear();
+  for (auto& up : batch) {
+    auto u_ptr = g_->vertex_index->RetrieveVertex(up.src), v_ptr = g_->vertex_index->RetrieveVertex(up.des);
+    if (u_ptr == nullptr || v_ptr == nullptr || u_ptr->idx < 0 || v_ptr->idx < 0) continue;
+    for (int dir = 0; dir < (reverse_ == nullptr ? 2 : 1); dir++) {
+      int u = dir ? v_ptr->idx : u_ptr->idx, v = dir ? u_ptr->idx : v_ptr->idx;
+      if (parent[v] == u && v != source_idx_) stack_.push_back(v);
+      if (!up.deleted && dist[u] < kDistInf) queue_.push({dist[u], u});
+    }
+  }
+
+  // Collect the subtrees through the children of each vertex in the tree
+  affected_.clear();
+  while (!stack_.empty()) {
+    int u = stack_.back();
+    stack_.pop_back();
+    if (marked_[u]) continue;
+    marked_[u] = 1;
+    affected_.push_back(u);
+    g_->GetNeighboursByOffset(u, neighbours_);
+    for (auto e : neighbours_) {
+      int v = e.idx;
+      if (v < (int)parent.size() && parent[v] == u && !marked_[v] && v != source_idx_) stack_.push_back(v);
+    }
+  }
+  for (int v : affected_) {
+    dist[v] = kDistInf;
+    parent[v] = -1;
+  }
+
+  // Restart each of them from its best in-neighbour outside the subtrees
+  for (int v : affected_) {
+    InNeighbours(v);
+    for (auto e : neighbours_) {
+      int u = e.idx;
+      if (u >= (int)dist.size() || dist[u] >= kDistInf) continue;
+      WeightT new_dist = dist[u] + (unweighted_ ? 1 : e.weight);
+      if (new_dist < dist[v]) {
+        dist[v] = new_dist;
+        parent[v] = u;
+      }
+    }
+    if (dist[v] < kDistInf) queue_.push({dist[v], v});
+    marked_[v] = 0;
+  }
+  return affected_.size() + Propagate();
+}
@@ -0,0 +1,54 @@
+//
+// Incremental maintenance of single-source shortest paths
+//
+
+#ifndef GRAPHINDEX_DYNAMIC_SSSP_H
+#define GRAPHINDEX_DYNAMIC_SSSP_H
+
+#include <queue>
+
+#include "benchmark.h"
+#include "pvector.h"
+#include "sssp.h"
+#include "../radixgraph.h"
+
+// Maintains the distances and a shortest-path tree from one source vertex ID
+// under batches of edge insertions, deletions and weight updates. Distances
+// follow out-edges; reverse is a RadixGraph holding every edge reversed
+// (nullptr if the graph is symmetric, in which case every update stands for
+// both directions). Unweighted mode counts hops. Updates must not run
+// concurrently. Unlike the other maintainers, it does not apply the updates
+// itself, so that several of them (e.g., one per hub) can share a graph.
+class DynamicSSSP {
+ public:
+  // By vertex offset: distance from the source (kDistInf if unreachable), and
+  // the parent offset in the shortest-path tree (-1 if unreachable; the
+  // source is its own parent)
+  pvector<WeightT> dist;
+  pvector<int> parent;
+
+  DynamicSSSP(RadixGraph* g, NodeID source, RadixGraph* reverse = nullptr, bool unweighted = false);
+
+  // Repair the results after the batch has been applied to the graph (and to
+  // reverse); returns the number of vertices whose distance was reset or lowered
+  int64_t Update(const std::vector<EdgeUpdate>& batch);
+
+ private:
+  typedef std::pair<WeightT, int> QueueItem;
+
+  RadixGraph* g_;
+  RadixGraph* reverse_;
+  NodeID source_;
+  int source_idx_ = -1;
+  bool unweighted_;
+  std::vector<WeightedEdge> neighbours_;
+  std::vector<int> affected_, stack_;
+  std::vector<uint8_t> marked_;
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue_;
+
+  void Grow();
+  void InNeighbours(int v);
+  int64_t Propagate();
+};
+
+#endif //GRAPHINDEX_DYNAMIC_SSSP_H
@@ -0,0 +1,173 @@
+#include "kcore.h"
+
+/*
+Kernel: k-core decomposition
+
+Bucketed peeling in the style of Julienne [1]. Vertices are kept in buckets by
+their current degree. For k = 0, 1, ..., the vertices in bucket k are removed
+in parallel rounds: each removed vertex gets core number k and decrements the
+degrees of its live neighbours, never below k. Neighbours dropping to k are
+peeled in the next round of the same k, and all other moved neighbours are
+re-bucketed once per round by their new degree (stale bucket entries are
+skipped).
+
+DynamicKCore handles insertions with the subcore traversal algorithm [2]: an
+edge can only raise core numbers by one, and only for the vertices with core
+number K = min(core[u], core[v]) connected to the endpoints through such
+vertices. Within this subcore, vertices with at most K neighbours in a
+higher core or in the subcore are evicted repeatedly; the remaining ones move
+to core K + 1.
+
+[1] Laxman Dhulipala, Guy Blelloch, and Julian Shun. "Julienne: A Framework
+    for Parallel Graph Algorithms using Work-efficient Bucketing" SPAA 2017.
+
+[2] Ahmet Erdem Sarıyüce, Buğra Gedik, Gabriela Jacques-Silva, Kun-Lung Wu,
+    and Ümit V. Çatalyürek. "Streaming Algorithms for k-core Decomposition"
+    VLDB 2013.
+*/
+pvector<int> KCore(RadixGraph* g, uint32_t num_nodes) {
+  pvector<int> core(num_nodes, 0);
+  pvector<int> degree(num_nodes);
+  pvector<uint8_t> removed(num_nodes, 0), moved(num_nodes, 0);
+  int max_degree = 0;
+  #pragma omp parallel reduction(max:max_degree)
+  {
+    std::vector<WeightedEdge> neighbours;
+    #pragma omp for schedule(dynamic, 256)
+    for (NodeID n = 0; n < num_nodes; n++) {
+      g->GetNeighboursByOffset(n, neighbours);
+      int d = 0;
+      for (auto e : neighbours) d += e.idx != (int)n && e.idx < (int)num_nodes;
+      degree[n] = d;
+      max_degree = std::max(max_degree, d);
+    }
+  }
+  std::vector<tbb::concurrent_vector<int>> buckets(max_degree + 1);
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_nodes; n++) buckets[degree[n]].push_back(n);
+
+  int64_t num_removed = 0;
+  std::vector<int> frontier;
+  for (int k = 0; k <= max_degree && num_removed < num_nodes; k++) {
+    while (!buckets[k].empty()) {
+      // Take the live vertices of bucket k, each once
+      frontier.clear();
+      for (int v : buckets[k]) {
+        if (!removed[v] && degree[v] <= k) {
+          removed[v] = 1;
+          frontier.push_back(v);
+        }
+      }
+      tbb::concurrent_vector<int>().swap(buckets[k]);
+      num_removed += frontier.size();
+      #pragma omp parallel
+      {
+        std::vector<WeightedEdge> neighbours;
+        std::vector<int> local_moved;
+        #pragma omp for schedule(dynamic, 64) nowait
+        for (size_t i = 0; i < frontier.size(); i++) {
+          int v = frontier[i];
+          core[v] = k;
+          g->GetNeighboursByOffset(v, neighbours);
+          for (auto e : neighbours) {
+            int w = e.idx;
+            if (w >= (int)num_nodes || removed[w]) continue;
+            int old_degree = degree[w];
+            while (old_degree > k && !compare_and_swap(degree[w], old_degree, old_degree - 1)) {
+              old_degree = degree[w];
+            }
+            if (old_degree > k && !moved[w] && compare_and_swap(moved[w], (uint8_t)0, (uint8_t)1)) {
+              local_moved.push_back(w);
+            }
+          }
+        }
+        #pragma omp barrier
+        for (int w : local_moved) {
+          moved[w] = 0;
+          buckets[degree[w]].push_back(w);
+        }
+      }
+    }
+  }
+  return core;
+}
+
+DynamicKCore::DynamicKCore(RadixGraph* g, uint32_t num_nodes) : g_(g) {
+  auto cores = KCore(g, num_nodes);
+  core.assign(cores.begin(), cores.end());
+  cd_.assign(num_nodes, 0);
+  state_.assign(num_nodes, 0);
+}
+
+bool DynamicKCore::InsertEdge(NodeID u, NodeID v, double weight) {
+  if (!g_->InsertUndirectedEdge(u, v, weight)) {
+    return false;
+  }
+  int u_idx = g_->vertex_index->RetrieveVertex(u)->idx, v_idx = g_->vertex_index->RetrieveVertex(v)->idx;
+  if ((int)core.size() < g_->vertex_index->cnt) {
+    core.resize(g_->vertex_index->cnt, 0);
+    cd_.resize(core.size(), 0);
+    state_.resize(core.size(), 0);
+  }
+  if (u_idx == v_idx) return true;
+  int K = std::min(core[u_idx], core[v_idx]);
+
+  // Collect the subcore reachable from the endpoints with core number K (state 1),
+  // counting for each vertex its neighbours in a higher core or in the subcore
+  enum { kUnseen = 0, kCandidate = 1, kEvicted = 2 };
+  visited_.clear();
+  stack_.clear();
+  for (int r : {u_idx, v_idx}) {
+    if (core[r] == K && state_[r] == kUnseen) {
+      state_[r] = kCandidate;
+      visited_.push_back(r);
+      stack_.push_back(r);
+    }
+  }
+  while (!stack_.empty()) {
+    int x = stack_.back();
+    stack_.pop_back();
+    g_->GetNeighboursByOffset(x, neighbours_);
+    int cd = 0;
+    for (auto e : neighbours_) {
+      int y = e.idx;
+      if (y == x || y >= (int)core.size()) continue;
+      if (core[y] > K) cd++;
+      else if (core[y] == K) {
+        cd++;
+        if (state_[y] == kUnseen) {
+          state_[y] = kCandidate;
+          visited_.push_back(y);
+          stack_.push_back(y);
+        }
+      }
+    }
+    cd_[x] = cd;
+  }
+
+  // Evict candidates that cannot have more than K neighbours in the (K+1)-core
+  for (int x : visited_) {
+    if (state_[x] == kCandidate && cd_[x] <= K) {
+      state_[x] = kEvicted;
+      stack_.push_back(x);
+    }
+  }
+  while (!stack_.empty()) {
+    int x = stack_.back();
+    stack_.pop_back();
+    g_->GetNeighboursByOffset(x, neighbours_);
+    for (auto e : neighbours_) {
+      int y = e.idx;
+      if (y == x || y >= (int)core.size() || state_[y] != kCandidate) continue;
+      if (--cd_[y] <= K) {
+        state_[y] = kEvicted;
+        stack_.push_back(y);
+      }
+    }
+  }
+  for (int x : visited_) {
+    if (state_[x] == kCandidate) core[x]++;
+    state_[x] = kUnseen;
+  }
+  return true;
+}
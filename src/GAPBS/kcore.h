@@ -0,0 +1,40 @@
+//
+// k-core decomposition
+//
+
+#ifndef GRAPHINDEX_KCORE_H
+#define GRAPHINDEX_KCORE_H
+
+#include <tbb/concurrent_vector.h>
+
+#include "benchmark.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+#include "../radixgraph.h"
+
+// Core number of every vertex offset of a symmetric graph (self loops are ignored)
+pvector<int> KCore(RadixGraph* g, uint32_t num_nodes);
+
+// Maintains core numbers of an undirected RadixGraph under edge insertions.
+// Each insertion is applied to both directions in the graph and only visits
+// the vertices whose core number equals the smaller one of its endpoints and
+// that are connected to them through such vertices. Updates must not run
+// concurrently.
+class DynamicKCore {
+ public:
+  std::vector<int> core;
+
+  DynamicKCore(RadixGraph* g, uint32_t num_nodes);
+
+  // Insert (or update the weight of) undirected edge (u, v); returns false if it already existed
+  bool InsertEdge(NodeID u, NodeID v, double weight);
+
+ private:
+  RadixGraph* g_;
+  std::vector<WeightedEdge> neighbours_;
+  // Subcore traversal state, cleared through the list of visited vertices
+  std::vector<int> visited_, stack_, cd_;
+  std::vector<uint8_t> state_;
+};
+
+#endif //GRAPHINDEX_KCORE_H
@@ -0,0 +1,219 @@
+//
+// Ligra-style frontier engine: VertexSubset, EdgeMap and VertexMap
+//
+
+#ifndef GRAPHINDEX_LIGRA_H
+#define GRAPHINDEX_LIGRA_H
+
+#include "benchmark.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+#include "../radixgraph.h"
+
+/*
+Frontier engine after Ligra [1]
+
+A VertexSubset is a set of vertex offsets kept either sparse (a list of
+offsets) or dense (one flag per vertex), and converted on demand.
+
+EdgeMap(g, U, f) applies f to the edges leaving U and returns the subset of
+destinations d for which an update returned true. f provides:
+  bool update(int s, int d, EdgeWeight w)        // d is only updated by one thread
+  bool updateAtomic(int s, int d, EdgeWeight w)  // may race with other updates of d
+  bool cond(int d)                               // whether d still wants updates
+Like DOBFS, it picks the direction per call: when U and its out-edges exceed
+threshold (num_edges / 20 by default), it goes dense, otherwise it pushes from
+the sparse list (with updateAtomic). Dense steps pull (with update, stopping
+once cond(d) fails) on symmetric graphs, where neighbour lists double as
+in-neighbour lists; on other graphs they push from every flagged vertex.
+Sparse outputs are sorted and duplicate-free.
+
+[1] Julian Shun and Guy E. Blelloch. "Ligra: A Lightweight Graph Processing
+    Framework for Shared Memory" PPoPP 2013.
+*/
+
+class VertexSubset {
+ public:
+  // Empty subset of [0, num_nodes)
+  explicit VertexSubset(uint32_t num_nodes) : num_nodes_(num_nodes) {}
+  VertexSubset(uint32_t num_nodes, std::vector<int>&& ids)
+      : num_nodes_(num_nodes), size_(ids.size()), ids_(std::move(ids)) {}
+  VertexSubset(uint32_t num_nodes, pvector<uint8_t>&& flags, int64_t size)
+      : num_nodes_(num_nodes), size_(size), dense_(true), flags_(std::move(flags)) {}
+  VertexSubset(VertexSubset&& other) = default;
+  VertexSubset& operator=(VertexSubset&& other) = default;
+
+  // Every vertex in [0, num_nodes)
+  static VertexSubset All(uint32_t num_nodes) {
+    return VertexSubset(num_nodes, pvector<uint8_t>(num_nodes, 1), num_nodes);
+  }
+
+  uint32_t num_nodes() const { return num_nodes_; }
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool dense() const { return dense_; }
+  // Membership test; requires the dense form
+  bool Contains(int v) const { return flags_[v]; }
+  const std::vector<int>& ids() const { return ids_; }
+
+  void ToDense() {
+    if (dense_) return;
+    flags_ = pvector<uint8_t>(num_nodes_, 0);
+    #pragma omp parallel for
+    for (size_t i = 0; i < ids_.size(); i++) flags_[ids_[i]] = 1;
+    std::vector<int>().swap(ids_);
+    dense_ = true;
+  }
+
+  void ToSparse() {
+    if (!dense_) return;
+    ids_.clear();
+    ids_.reserve(size_);
+    for (NodeID n = 0; n < num_nodes_; n++) {
+      if (flags_[n]) ids_.push_back(n);
+    }
+    flags_ = pvector<uint8_t>();
+    dense_ = false;
+  }
+
+  // Calls f(v) for every member in parallel
+  template <typename F>
+  void ForEach(F f) const {
+    if (dense_) {
+      #pragma omp parallel for schedule(dynamic, 1024)
+      for (NodeID n = 0; n < num_nodes_; n++) {
+        if (flags_[n]) f(n);
+      }
+    }
+    else {
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (size_t i = 0; i < ids_.size(); i++) f(ids_[i]);
+    }
+  }
+
+ private:
+  uint32_t num_nodes_;
+  int64_t size_ = 0;
+  bool dense_ = false;
+  std::vector<int> ids_;
+  pvector<uint8_t> flags_;
+};
+
+// Calls f(v) for every member of U in parallel
+template <typename F>
+void VertexMap(const VertexSubset& U, F f) {
+  U.ForEach(f);
+}
+
+// The members v of U for which f(v) returns true (f runs once per member, in parallel)
+template <typename F>
+VertexSubset VertexFilter(const VertexSubset& U, F f) {
+  if (U.dense()) {
+    pvector<uint8_t> flags(U.num_nodes(), 0);
+    int64_t size = 0;
+    #pragma omp parallel for reduction(+:size) schedule(dynamic, 1024)
+    for (NodeID n = 0; n < U.num_nodes(); n++) {
+      if (U.Contains(n) && f(n)) flags[n] = 1, size++;
+    }
+    return VertexSubset(U.num_nodes(), std::move(flags), size);
+  }
+  const std::vector<int>& ids = U.ids();
+  pvector<uint8_t> keep(ids.size());
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t i = 0; i < ids.size(); i++) keep[i] = f(ids[i]);
+  std::vector<int> out;
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (keep[i]) out.push_back(ids[i]);
+  }
+  return VertexSubset(U.num_nodes(), std::move(out));
+}
+
+// Applies f to the out-edges of U (see above); U may be converted in place
+template <typename F>
+VertexSubset EdgeMap(RadixGraph* g, VertexSubset& U, F& f, int64_t num_edges,
+                     bool symmetric = false, int64_t threshold = -1) {
+  uint32_t num_nodes = U.num_nodes();
+  if (threshold < 0) threshold = num_edges / 20;
+  int64_t out_degrees = 0;
+  if (U.dense()) {
+    #pragma omp parallel for reduction(+:out_degrees)
+    for (NodeID n = 0; n < num_nodes; n++) {
+      if (U.Contains(n)) out_degrees += g->vertex_index->vertex_table[n].deg;
+    }
+  }
+  else {
+    const std::vector<int>& ids = U.ids();
+    #pragma omp parallel for reduction(+:out_degrees)
+    for (size_t i = 0; i < ids.size(); i++) out_degrees += g->vertex_index->vertex_table[ids[i]].deg;
+  }
+
+  if (U.size() + out_degrees > threshold) {
+    U.ToDense();
+    pvector<uint8_t> next(num_nodes, 0);
+    int64_t size = 0;
+    if (symmetric) {
+      // Pull: every vertex that still wants updates scans its neighbours for members of U
+      #pragma omp parallel reduction(+:size)
+      {
+        std::vector<WeightedEdge> neighbours;
+        #pragma omp for schedule(dynamic, 1024)
+        for (NodeID d = 0; d < num_nodes; d++) {
+          if (!f.cond(d)) continue;
+          g->GetNeighboursByOffset(d, neighbours);
+          for (auto e : neighbours) {
+            int s = e.idx;
+            if (s < (int)num_nodes && U.Contains(s) && f.update(s, d, e.weight) && !next[d]) {
+              next[d] = 1;
+              size++;
+            }
+            if (!f.cond(d)) break;
+          }
+        }
+      }
+    }
+    else {
+      // Push from every member of U
+      #pragma omp parallel
+      {
+        std::vector<WeightedEdge> neighbours;
+        #pragma omp for schedule(dynamic, 1024)
+        for (NodeID s = 0; s < num_nodes; s++) {
+          if (!U.Contains(s)) continue;
+          g->GetNeighboursByOffset(s, neighbours);
+          for (auto e : neighbours) {
+            int d = e.idx;
+            if (d < (int)num_nodes && f.cond(d) && f.updateAtomic(s, d, e.weight)) next[d] = 1;
+          }
+        }
+      }
+      #pragma omp parallel for reduction(+:size)
+      for (NodeID n = 0; n < num_nodes; n++) size += next[n];
+    }
+    return VertexSubset(num_nodes, std::move(next), size);
+  }
+
+  U.ToSparse();
+  const std::vector<int>& ids = U.ids();
+  std::vector<int> out;
+  #pragma omp parallel
+  {
+    std::vector<WeightedEdge> neighbours;
+    std::vector<int> local_out;
+    #pragma omp for schedule(dynamic, 64) nowait
+    for (size_t i = 0; i < ids.size(); i++) {
+      int s = ids[i];
+      g->GetNeighboursByOffset(s, neighbours);
+      for (auto e : neighbours) {
+        int d = e.idx;
+        if (d < (int)num_nodes && f.cond(d) && f.updateAtomic(s, d, e.weight)) local_out.push_back(d);
+      }
+    }
+    #pragma omp critical
+    out.insert(out.end(), local_out.begin(), local_out.end());
+  }
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return VertexSubset(num_nodes, std::move(out));
+}
+
+#endif //GRAPHINDEX_LIGRA_H
@@ -0,0 +1,91 @@
+#include "lpa.h"
+
+/*
+Kernel: Label Propagation (LPA)
+
+Every vertex repeatedly adopts the label that is most frequent among its
+neighbours [1], keeping its own label on ties if possible (the smallest label
+otherwise), which damps oscillation. Updates are asynchronous: labels are
+changed in place and read by the rest of the round right away. Only vertices
+with a neighbour whose label changed are re-evaluated in the next round, so
+later rounds (and runs resumed after graph updates) cost time proportional to
+the changes. Frontiers are managed by VertexFilter and EdgeMap (see ligra.h).
+
+[1] Usha Nandini Raghavan, Réka Albert, and Soundar Kumara. "Near linear time
+    algorithm to detect community structures in large-scale networks"
+    Physical Review E, 76(3), 2007.
+*/
+namespace {
+
+// Activates every neighbour of a vertex whose label changed
+struct Activate {
+  bool update(int, int, EdgeWeight) { return true; }
+  bool updateAtomic(int, int, EdgeWeight) { return true; }
+  bool cond(int) { return true; }
+};
+
+// Adopt the most frequent neighbour label of v; returns whether the label changed.
+// Labels of neighbours are written by other threads meanwhile, hence the relaxed atomics
+bool UpdateLabel(RadixGraph* g, uint32_t num_nodes, pvector<NodeID>& labels, int v) {
+  static thread_local std::vector<WeightedEdge> neighbours;
+  static thread_local std::vector<NodeID> neighbour_labels;
+  g->GetNeighboursByOffset(v, neighbours);
+  neighbour_labels.clear();
+  for (auto e : neighbours) {
+    if ((int)e.idx != v && e.idx < (int)num_nodes)
+      neighbour_labels.push_back(std::atomic_ref<NodeID>(labels[e.idx]).load(std::memory_order_relaxed));
+  }
+  if (neighbour_labels.empty()) return false;
+  std::sort(neighbour_labels.begin(), neighbour_labels.end());
+  NodeID current = std::atomic_ref<NodeID>(labels[v]).load(std::memory_order_relaxed), best = current;
+  int best_count = 0, current_count = 0;
+  for (size_t i = 0, j; i < neighbour_labels.size(); i = j) {
+    for (j = i; j < neighbour_labels.size() && neighbour_labels[j] == neighbour_labels[i]; j++);
+    int count = j - i;
+    if (neighbour_labels[i] == current) current_count = count;
+    if (count > best_count) best_count = count, best = neighbour_labels[i];
+  }
+  if (current_count == best_count || best == current) return false;
+  std::atomic_ref<NodeID>(labels[v]).store(best, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace
+
+int LabelPropagation(RadixGraph* g, uint32_t num_nodes, pvector<NodeID>& labels,
+                     const std::vector<int>& active, int max_iters) {
+  size_t old_size = labels.size();
+  if (old_size < num_nodes) {
+    labels.resize(num_nodes);
+    for (NodeID n = old_size; n < num_nodes; n++) labels[n] = n;
+  }
+  int64_t num_edges = 0;
+  #pragma omp parallel for reduction(+:num_edges)
+  for (NodeID n = 0; n < num_nodes; n++) num_edges += g->vertex_index->vertex_table[n].deg;
+  std::vector<int> ids;
+  for (int v : active) {
+    if (v >= 0 && v < (int)num_nodes) ids.push_back(v);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  VertexSubset frontier(num_nodes, std::move(ids));
+  Activate activate;
+  int iter = 0;
+  while (!frontier.empty() && iter < max_iters) {
+    iter++;
+    VertexSubset changed = VertexFilter(frontier, [&](int v) {
+      return UpdateLabel(g, num_nodes, labels, v);
+    });
+    frontier = EdgeMap(g, changed, activate, num_edges);
+  }
+  return iter;
+}
+
+pvector<NodeID> LabelPropagation(RadixGraph* g, uint32_t num_nodes, int max_iters) {
+  pvector<NodeID> labels(num_nodes);
+  std::vector<int> active(num_nodes);
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_nodes; n++) labels[n] = n, active[n] = n;
+  LabelPropagation(g, num_nodes, labels, active, max_iters);
+  return labels;
+}
@@ -0,0 +1,26 @@
+//
+// Community detection with label propagation
+//
+
+#ifndef GRAPHINDEX_LPA_H
+#define GRAPHINDEX_LPA_H
+
+#include <atomic>
+
+#include "benchmark.h"
+#include "ligra.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+#include "../radixgraph.h"
+
+// Community label (an offset) of every vertex offset, starting from singleton
+// communities; the graph should be symmetric
+pvector<NodeID> LabelPropagation(RadixGraph* g, uint32_t num_nodes, int max_iters = 20);
+// Continue from existing labels after graph updates, with only the given
+// vertex offsets (e.g., endpoints of updated edges) active at first; labels is
+// grown to num_nodes, new vertices starting in their own community. Returns
+// the number of rounds used (max_iters if not converged).
+int LabelPropagation(RadixGraph* g, uint32_t num_nodes, pvector<NodeID>& labels,
+                     const std::vector<int>& active, int max_iters = 20);
+
+#endif //GRAPHINDEX_LPA_H
@@ -0,0 +1,22 @@
+//
+// Multi-source bit-parallel BFS
+//
+
+#ifndef GRAPHINDEX_MSBFS_H
+#define GRAPHINDEX_MSBFS_H
+
+#include "benchmark.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+#include "sliding_queue.h"
+#include "../radixgraph.h"
+
+// Sources traversed together by one pass over the neighbour lists
+const int kMSBFSMaxLanes = 256;
+
+// Hop distances from every source (a vertex ID) to every vertex offset, -1 if
+// unreachable (or if the source does not exist)
+std::vector<pvector<int>> MultiSourceBFS(RadixGraph* g, const std::vector<NodeID>& sources,
+                                         uint32_t num_nodes);
+
+#endif //GRAPHINDEX_MSBFS_H
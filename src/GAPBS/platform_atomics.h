@@ -4,6 +4,8 @@
 #ifndef PLATFORM_ATOMICS_H_
 #define PLATFORM_ATOMICS_H_
 
+#include <cstdint>
+
 
 /*
 GAP Benchmark Suite
@@ -13,20 +15,68 @@ Author: Scott Beamer
 Wrappers for compiler intrinsics for atomic memory operations (AMOs)
  - If not using OpenMP (serial), provides serial fallbacks
 */
-template<typename T, typename U>
-T fetch_and_add(T &x, U inc) {
-  T orig_val = x;
-  x += inc;
-  return orig_val;
-}
-
-template<typename T>
-bool compare_and_swap(T &x, const T &old_val, const T &new_val) {
-  if (x == old_val) {
-    x = new_val;
-    return true;
+
+
+#if defined _OPENMP
+
+  #if defined __GNUC__
+
+    // gcc/clang/icc instrinsics
+
+    template<typename T, typename U>
+    T fetch_and_add(T &x, U inc) {
+      return __sync_fetch_and_add(&x, inc);
+    }
+
+    template<typename T>
+    bool compare_and_swap(T &x, const T &old_val, const T &new_val) {
+      return __sync_bool_compare_and_swap(&x, old_val, new_val);
+    }
+
+    template<>
+    inline bool compare_and_swap(float &x, const float &old_val,
+                                 const float &new_val) {
+      return __sync_bool_compare_and_swap(
+          reinterpret_cast<uint32_t*>(&x),
+          reinterpret_cast<const uint32_t&>(old_val),
+          reinterpret_cast<const uint32_t&>(new_val));
+    }
+
+    template<>
+    inline bool compare_and_swap(double &x, const double &old_val,
+                                 const double &new_val) {
+      return __sync_bool_compare_and_swap(
+          reinterpret_cast<uint64_t*>(&x),
+          reinterpret_cast<const uint64_t&>(old_val),
+          reinterpret_cast<const uint64_t&>(new_val));
+    }
+
+  #else   // defined __GNUC__
+
+    #error No atomics available for this compiler but using OpenMP
+
+  #endif  // else defined __GNUC__
+
+#else   // defined _OPENMP
+
+  // serial fallbacks
+
+  template<typename T, typename U>
+  T fetch_and_add(T &x, U inc) {
+    T orig_val = x;
+    x += inc;
+    return orig_val;
+  }
+
+  template<typename T>
+  bool compare_and_swap(T &x, const T &old_val, const T &new_val) {
+    if (x == old_val) {
+      x = new_val;
+      return true;
+    }
+    return false;
   }
-  return false;
-}
 
-#endif  // PLATFORM_ATOMICS_H_
\ No newline at end of file
+#endif  // else defined _OPENMP
+
+#endif  // PLATFORM_ATOMICS_H_
@@ -0,0 +1,25 @@
+//
+// Personalized PageRank by local forward push
+//
+
+#ifndef GRAPHINDEX_PPR_H
+#define GRAPHINDEX_PPR_H
+
+#include "benchmark.h"
+#include "pr_spmv.h"
+#include "../radixgraph.h"
+
+// (offset, score) pairs of the vertices with a non-zero estimate, by descending score
+typedef std::vector<std::pair<int, ScoreT>> PPRVector;
+
+// Approximate PPR of source (a vertex ID) with teleport probability alpha,
+// following out-edges. Every vertex keeps a residual below epsilon * degree,
+// so the L1 error is at most epsilon * (number of edges reached). Only
+// vertices near the source are touched.
+PPRVector PersonalizedPageRank(RadixGraph* g, NodeID source, double alpha = 0.15,
+                               double epsilon = 1e-6);
+// One independent query per source, answered in parallel
+std::vector<PPRVector> PersonalizedPageRankBatch(RadixGraph* g, const std::vector<NodeID>& sources,
+                                                 double alpha = 0.15, double epsilon = 1e-6);
+
+#endif //GRAPHINDEX_PPR_H
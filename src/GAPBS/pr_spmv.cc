@@ -16,20 +16,46 @@ but it is not necesarily the fastest way to implement it. It performs each
 iteration as a sparse-matrix vector multiply (SpMV), and values are not visible
 until the next iteration (like Jacobi-style method).
 */
+namespace {
+
+// Sums the contributions of the neighbours of every vertex
+struct PullGather {
+  const pvector<ScoreT>& contrib;
+  pvector<ScoreT>& incoming;
+
+  bool update(int s, int d, EdgeWeight) {
+    incoming[d] += contrib[s];
+    return false;
+  }
+  bool updateAtomic(int s, int d, EdgeWeight) {
+    #pragma omp atomic
+    incoming[d] += contrib[s];
+    return false;
+  }
+  bool cond(int) { return true; }
+};
+
+}  // namespace
+
 pvector<ScoreT> PageRankPull(RadixGraph* g, int max_iters,
-                             uint32_t num_nodes, double epsilon) {
+                             uint32_t num_nodes, double epsilon, int* num_iters) {
 
   const ScoreT init_score = 1.0f / num_nodes;
   const ScoreT base_score = (1.0f - kDamp) / num_nodes;
   pvector<ScoreT> scores(num_nodes, init_score);
   pvector<ScoreT> outgoing_contrib(num_nodes, 0.0);
-  for (int iter=0; iter < max_iters; iter++) {
+  pvector<ScoreT> incoming(num_nodes);
+  PullGather gather{outgoing_contrib, incoming};
+  int iter = 0;
+  while (iter < max_iters) {
+      iter++;
       double error = 0;
       double dangling_sum = 0.0;
 
       #pragma omp parallel for reduction(+:dangling_sum)
       for (NodeID n = 0; n < num_nodes; n++) {
           uint32_t out_degree = g->degree[n];
+          incoming[n] = 0;
           if (out_degree == 0) {
               dangling_sum += scores[n];
           }
@@ -39,16 +65,341 @@ pvector<ScoreT> PageRankPull(RadixGraph* g, int max_iters,
       }
 
       dangling_sum /= num_nodes;
-      #pragma omp parallel for schedule(guided)
+      // Every vertex pulls, so the gather is forced dense
+      VertexSubset all = VertexSubset::All(num_nodes);
+      EdgeMap(g, all, gather, 0, true, 0);
+      #pragma omp parallel for reduction(+:error)
+      for (NodeID n = 0; n < num_nodes; n++) {
+        ScoreT old_score = scores[n];
+        scores[n] = base_score + kDamp * (incoming[n] + dangling_sum);
+        error += fabs(scores[n] - old_score);
+      }
+      if (error < epsilon)
+        break;
+  }
+  if (num_iters) *num_iters = iter;
+  return scores;
+}
+
+
+/*
+Gauss-Seidel variant: outgoing contributions are updated in place, so later
+vertices of a thread's chunk already pull the new values of earlier ones.
+Across chunks this is a chaotic relaxation: contributions are exchanged with
+relaxed atomic loads and stores, and a vertex may see either the old or the
+new value of a neighbour owned by another thread. Every update is still a
+PageRank step, so it reaches the same fixed point as PageRankPull (up to
+epsilon), but the exact scores and the number of iterations depend on the
+schedule. Which of the two needs fewer iterations depends on the graph and
+the vertex order.
+*/
+pvector<ScoreT> PageRankPullGS(RadixGraph* g, int max_iters,
+                               uint32_t num_nodes, double epsilon, int* num_iters) {
+  const ScoreT init_score = 1.0f / num_nodes;
+  const ScoreT base_score = (1.0f - kDamp) / num_nodes;
+  pvector<ScoreT> scores(num_nodes, init_score);
+  pvector<ScoreT> outgoing_contrib(num_nodes, 0.0);
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_nodes; n++) {
+    uint32_t out_degree = g->degree[n];
+    if (out_degree != 0) outgoing_contrib[n] = init_score / out_degree;
+  }
+  int iter = 0;
+  while (iter < max_iters) {
+    iter++;
+    double error = 0;
+    double dangling_sum = 0.0;
+    #pragma omp parallel for reduction(+:dangling_sum)
+    for (NodeID n = 0; n < num_nodes; n++) {
+      if (g->degree[n] == 0) dangling_sum += scores[n];
+    }
+    dangling_sum /= num_nodes;
+    #pragma omp parallel
+    {
+      std::vector<WeightedEdge> neighbours;
+      #pragma omp for reduction(+:error) schedule(dynamic, 16384)
       for (NodeID n = 0; n < num_nodes; n++) {
         ScoreT incoming_total = 0;
-        std::vector<WeightedEdge> neighbours;
         g->GetNeighboursByOffset(n, neighbours);
         for (auto e : neighbours) {
-          incoming_total += outgoing_contrib[e.idx];
+          incoming_total += std::atomic_ref<ScoreT>(outgoing_contrib[e.idx]).load(std::memory_order_relaxed);
         }
+        ScoreT old_score = scores[n];
         scores[n] = base_score + kDamp * (incoming_total + dangling_sum);
+        error += fabs(scores[n] - old_score);
+        uint32_t out_degree = g->degree[n];
+        if (out_degree != 0) {
+          std::atomic_ref<ScoreT>(outgoing_contrib[n]).store(scores[n] / out_degree, std::memory_order_relaxed);
+        }
       }
+    }
+    if (error < epsilon)
+      break;
   }
+  if (num_iters) *num_iters = iter;
   return scores;
-}
\ No newline at end of file
+}
+
+
+/*
+Push/delta variant: after a first dense pull iteration, only the change of
+scores is propagated. Vertices whose change is at most epsilon / num_nodes are
+not processed, so the work of each iteration shrinks with the set of vertices
+that still move. Their changes are kept in a residual and pushed once it grows
+past the threshold, so skipped changes are delayed rather than lost. Changes
+are pushed along neighbour lists, which matches the pull variants on symmetric
+graphs. Changes of dangling vertices are spread uniformly, as in PageRankPull.
+The pushes run on EdgeMap (see ligra.h), which switches between sparse and
+dense frontiers as the active set shrinks.
+*/
+namespace {
+
+// Pushes the change of score of every active vertex to its neighbours
+struct DeltaPush {
+  const pvector<ScoreT>& contrib;
+  pvector<ScoreT>& next_delta;
+
+  bool update(int s, int d, EdgeWeight) {
+    next_delta[d] += contrib[s];
+    return false;
+  }
+  bool updateAtomic(int s, int d, EdgeWeight) {
+    #pragma omp atomic
+    next_delta[d] += contrib[s];
+    return false;
+  }
+  bool cond(int) { return true; }
+};
+
+}  // namespace
+
+pvector<ScoreT> PageRankDelta(RadixGraph* g, int max_iters,
+                              uint32_t num_nodes, double epsilon, int* num_iters) {
+  const ScoreT threshold = epsilon / num_nodes;
+  int iter = 0;
+  pvector<ScoreT> scores = PageRankPull(g, 1, num_nodes, 0, &iter);
+  pvector<ScoreT> delta(num_nodes), next_delta(num_nodes), contrib(num_nodes);
+  pvector<ScoreT> residual(num_nodes, 0);
+  const ScoreT init_score = 1.0f / num_nodes;
+  double error = 0;
+  int64_t num_edges = 0;
+  #pragma omp parallel for reduction(+:error, num_edges)
+  for (NodeID n = 0; n < num_nodes; n++) {
+    delta[n] = scores[n] - init_score;
+    error += fabs(delta[n]);
+    num_edges += g->degree[n];
+  }
+  DeltaPush push{contrib, next_delta};
+  while (error >= epsilon && iter < max_iters) {
+    iter++;
+    next_delta.fill(0);
+    double dangling_delta = 0;
+    VertexSubset all = VertexSubset::All(num_nodes);
+    VertexSubset frontier = VertexFilter(all, [&](int u) {
+      const ScoreT d = delta[u] + residual[u];
+      if (fabs(d) <= threshold) {
+        residual[u] = d;
+        return false;
+      }
+      residual[u] = 0;
+      uint32_t out_degree = g->degree[u];
+      if (out_degree == 0) {
+        #pragma omp atomic
+        dangling_delta += d;
+        return false;
+      }
+      contrib[u] = d / out_degree;
+      return true;
+    });
+    EdgeMap(g, frontier, push, num_edges);
+    const ScoreT uniform = kDamp * dangling_delta / num_nodes;
+    error = 0;
+    #pragma omp parallel for reduction(+:error)
+    for (NodeID n = 0; n < num_nodes; n++) {
+      next_delta[n] = kDamp * next_delta[n] + uniform;
+      scores[n] += next_delta[n];
+      error += fabs(next_delta[n]);
+    }
+    delta.swap(next_delta);
+  }
+  if (num_iters) *num_iters = iter;
+  return scores;
+}
+
+
+/*
+Dynamic PageRank
+
+Scores are kept across graph updates and repaired by residual push [1]. The
+residual of a vertex is the PageRank step applied to the current scores minus
+its score. Touched vertices (endpoints of updated edges) and their
+neighbours, whose incoming contributions depend on the touched degrees, get
+their residuals recomputed from the current scores. Then each round pushes
+every residual above epsilon: its owner adds the residual to its score and
+atomically adds the damped share to the residuals of its neighbours, which
+join the next round once their residual exceeds epsilon. Scores are only
+written by their owner, and residuals only through atomics. Residuals pushed
+by dangling vertices spread uniformly. They are accumulated and added to
+every residual once they exceed epsilon.
+
+[1] Frank McSherry. "A Uniform Approach to Accelerated PageRank Computation"
+    WWW 2005.
+*/
+DynamicPageRank::DynamicPageRank(RadixGraph* g, uint32_t num_nodes, int max_iters, double epsilon)
+    : g_(g), max_iters_(max_iters), epsilon_(epsilon) {
+  Reset(num_nodes);
+}
+
+int DynamicPageRank::Reset(uint32_t num_nodes) {
+  num_nodes_ = num_nodes;
+  int iters = 0;
+  scores = PageRankPull(g_, max_iters_, num_nodes, epsilon_, &iters);
+  residual_ = pvector<ScoreT>(num_nodes, 0);
+  queued_ = pvector<uint8_t>(num_nodes, 0);
+  dangling_ = pvector<uint8_t>(num_nodes);
+  double dangling_sum = 0;
+  #pragma omp parallel for reduction(+:dangling_sum)
+  for (NodeID n = 0; n < num_nodes; n++) {
+    dangling_[n] = g_->degree[n] == 0;
+    if (dangling_[n]) dangling_sum += scores[n];
+  }
+  dangling_sum_ = dangling_sum;
+  pending_uniform_ = 0;
+  touched_.clear();
+  return iters;
+}
+
+void DynamicPageRank::Touch(NodeID v) {
+  DummyNode* v_ptr = g_->vertex_index->RetrieveVertex(v);
+  if (v_ptr) TouchByOffset(v_ptr->idx);
+}
+
+void DynamicPageRank::TouchByOffset(int v) {
+  touched_.push_back(v);
+}
+
+int DynamicPageRank::Refresh(double epsilon) {
+  uint32_t num_nodes = g_->vertex_index->cnt;
+  if (num_nodes != num_nodes_) {
+    // New vertices change the teleport term of every vertex
+    return Reset(num_nodes);
+  }
+  const ScoreT base_score = (1.0f - kDamp) / num_nodes;
+  std::vector<int> frontier;
+  bool recompute_all = false;
+  {
+    std::vector<WeightedEdge> neighbours;
+    auto activate = [&](int u) {
+      if (!queued_[u]) queued_[u] = 1, frontier.push_back(u);
+    };
+    for (int v : touched_) {
+      activate(v);
+      g_->GetNeighboursByOffset(v, neighbours);
+      for (auto e : neighbours) activate(e.idx);
+      bool dangling = g_->degree[v] == 0;
+      if (dangling != dangling_[v]) {
+        dangling_[v] = dangling;
+        dangling_sum_ += dangling ? scores[v] : -scores[v];
+        const double uniform = kDamp * scores[v] / num_nodes;
+        if (uniform > epsilon) recompute_all = true;
+        else pending_uniform_ += dangling ? uniform : -uniform;
+      }
+    }
+    touched_.clear();
+  }
+  if (recompute_all) {
+    for (int v : frontier) queued_[v] = 0;
+    frontier.resize(num_nodes);
+    #pragma omp parallel for
+    for (NodeID n = 0; n < num_nodes; n++) frontier[n] = n, queued_[n] = 1;
+    pending_uniform_ = 0;
+  }
+
+  // Residuals of the frontier from the current scores, which are only read here.
+  // The pending uniform residual is left out, as it still gets spread to them.
+  const double dangling_term = dangling_sum_ / num_nodes - pending_uniform_ / kDamp;
+  #pragma omp parallel
+  {
+    std::vector<WeightedEdge> neighbours;
+    #pragma omp for schedule(dynamic, 64)
+    for (size_t i = 0; i < frontier.size(); i++) {
+      int v = frontier[i];
+      g_->GetNeighboursByOffset(v, neighbours);
+      ScoreT incoming_total = 0;
+      for (auto e : neighbours) {
+        int out_degree = g_->degree[e.idx];
+        if (out_degree > 0) incoming_total += scores[e.idx] / out_degree;
+      }
+      residual_[v] = base_score + kDamp * (incoming_total + dangling_term) - scores[v];
+    }
+  }
+  {
+    std::vector<int> active;
+    for (int v : frontier) {
+      if (fabs(residual_[v]) > epsilon) active.push_back(v);
+      else queued_[v] = 0;
+    }
+    frontier.swap(active);
+  }
+
+  int iter = 0;
+  while (!frontier.empty() && iter < max_iters_) {
+    iter++;
+    std::vector<int> next_frontier;
+    double dangling_delta = 0;
+    #pragma omp parallel reduction(+:dangling_delta)
+    {
+      std::vector<WeightedEdge> neighbours;
+      std::vector<int> local_frontier;
+      #pragma omp for schedule(dynamic, 64)
+      for (size_t i = 0; i < frontier.size(); i++) {
+        int u = frontier[i];
+        queued_[u] = 0;
+        ScoreT r;
+        #pragma omp atomic capture
+        { r = residual_[u]; residual_[u] = 0; }
+        scores[u] += r;
+        int out_degree = g_->degree[u];
+        if (out_degree == 0) {
+          dangling_delta += r;
+          continue;
+        }
+        const ScoreT share = kDamp * r / out_degree;
+        g_->GetNeighboursByOffset(u, neighbours);
+        for (auto e : neighbours) {
+          int w = e.idx;
+          ScoreT new_residual;
+          #pragma omp atomic capture
+          new_residual = residual_[w] += share;
+          if (fabs(new_residual) > epsilon && compare_and_swap(queued_[w], (uint8_t)0, (uint8_t)1)) {
+            local_frontier.push_back(w);
+          }
+        }
+      }
+      #pragma omp critical
+      next_frontier.insert(next_frontier.end(), local_frontier.begin(), local_frontier.end());
+    }
+    dangling_sum_ += dangling_delta;
+    pending_uniform_ += kDamp * dangling_delta / num_nodes;
+    if (fabs(pending_uniform_) > epsilon) {
+      // Spread the dangling residuals over every vertex
+      const ScoreT uniform = pending_uniform_;
+      pending_uniform_ = 0;
+      #pragma omp parallel
+      {
+        std::vector<int> local_frontier;
+        #pragma omp for
+        for (NodeID n = 0; n < num_nodes; n++) {
+          residual_[n] += uniform;
+          if (fabs(residual_[n]) > epsilon && !queued_[n]) queued_[n] = 1, local_frontier.push_back(n);
+        }
+        #pragma omp critical
+        next_frontier.insert(next_frontier.end(), local_frontier.begin(), local_frontier.end());
+      }
+    }
+    frontier.swap(next_frontier);
+  }
+  // Vertices left in the frontier (if max_iters_ is reached) are picked up by the next refresh
+  for (int v : frontier) queued_[v] = 0, touched_.push_back(v);
+  return iter;
+}
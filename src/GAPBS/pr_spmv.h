@@ -5,14 +5,59 @@
 #ifndef GRAPHINDEX_PR_SPMV_H
 #define GRAPHINDEX_PR_SPMV_H
 
+#include <atomic>
+
+#include <tbb/concurrent_vector.h>
+
 #include "benchmark.h"
+#include "ligra.h"
+#include "platform_atomics.h"
 #include "pvector.h"
 #include "../radixgraph.h"
 
 typedef float ScoreT;
 const float kDamp = 0.85;
 
+// All variants stop once the total change of an iteration is below epsilon
+// (or after max_iters iterations), and store the iterations used in num_iters
 pvector<ScoreT> PageRankPull(RadixGraph* g, int max_iters,
-                             uint32_t num_nodes, double epsilon = 0);
+                             uint32_t num_nodes, double epsilon = 0, int* num_iters = nullptr);
+pvector<ScoreT> PageRankPullGS(RadixGraph* g, int max_iters,
+                               uint32_t num_nodes, double epsilon = 0, int* num_iters = nullptr);
+pvector<ScoreT> PageRankDelta(RadixGraph* g, int max_iters,
+                              uint32_t num_nodes, double epsilon = 0, int* num_iters = nullptr);
+
+// Maintains PageRank scores under streaming edge updates. Like PageRankPull,
+// neighbour lists are treated as in-neighbours, so the graph should be
+// symmetric. After updating edges, Touch() both endpoints of each edge (safe
+// to call concurrently), then Refresh() before reading scores.
+class DynamicPageRank {
+ public:
+  pvector<ScoreT> scores;
+
+  DynamicPageRank(RadixGraph* g, uint32_t num_nodes, int max_iters = 100, double epsilon = 1e-7);
+
+  void Touch(NodeID v);
+  void TouchByOffset(int v);
+  // Push residuals until none exceeds epsilon; returns the number of rounds
+  // used (vertex insertions trigger a full recomputation, whose iterations
+  // are returned instead)
+  int Refresh(double epsilon = 1e-7);
+
+ private:
+  RadixGraph* g_;
+  uint32_t num_nodes_ = 0;
+  int max_iters_;
+  double epsilon_;
+  double dangling_sum_ = 0;
+  // Uniform residual pushed by dangling vertices and not yet spread
+  double pending_uniform_ = 0;
+  pvector<ScoreT> residual_;
+  pvector<uint8_t> queued_, dangling_;
+  tbb::concurrent_vector<int> touched_;
+
+  // Recompute the scores with PageRankPull; returns the iterations used
+  int Reset(uint32_t num_nodes);
+};
 
 #endif //GRAPHINDEX_PR_SPMV_H
@@ -0,0 +1,122 @@
+#include "random_walk.h"
+
+/*
+Kernel: Random Walks
+
+Every step samples one neighbour with RadixGraph::GetRandomNeighbourByOffset,
+which reads a single edge of a compacted block or of a clean log instead of
+materializing the neighbour list. Other logs are materialized into a cache of
+the walker and sampled from there, so rejected proposals at such a vertex do
+not read its log again. Weighted steps use rejection sampling against a
+per-vertex bound of the weights, computed once per run. Second-order node2vec
+steps [1] are sampled by rejection as well [2]: a proposed neighbour x of the
+current vertex is accepted with probability proportional to 1/p if x is the
+previous vertex t, 1 if x is a neighbour of t and 1/q otherwise, so no
+transition tables are built. Compacting the graph first keeps the neighbour
+check of t logarithmic.
+
+Walks are generated in blocks of kWalkBlock with one random engine per block,
+seeded from the block number.
+
+[1] Aditya Grover and Jure Leskovec. "node2vec: Scalable Feature Learning for
+    Networks" KDD 2016.
+
+[2] Ke Yang, Mingxing Zhang, Kang Chen, Xiaosong Ma, Yang Bai, and Yong Jiang.
+    "KnightKing: A Fast Distributed Graph Random Walk Engine" SOSP 2019.
+*/
+
+static const int64_t kWalkBlock = 256;
+
+// Walks [begin, end) into out, which has room for (end - begin) * walk_length IDs
+static void GenerateWalks(RadixGraph* g, uint32_t num_nodes, const WalkOptions& opt,
+                          const std::vector<float>& max_weight, int64_t begin, int64_t end, uint64_t* out) {
+  std::mt19937_64 rng(opt.seed * 0x9E3779B97F4A7C15ull + begin / kWalkBlock);
+  const bool second_order = opt.p != 1 || opt.q != 1;
+  const double return_prob = 1 / opt.p, out_prob = 1 / opt.q;
+  const double max_prob = std::max({return_prob, 1.0, out_prob}), min_prob = std::min({return_prob, 1.0, out_prob});
+  std::uniform_real_distribution<double> coin(0, max_prob);
+  NeighbourCache cache;
+  auto step = [&](int v, WeightedEdge& e) {
+    return opt.weighted ? g->GetWeightedRandomNeighbourByOffset(v, rng, e, max_weight[v], &cache)
+                        : g->GetRandomNeighbourByOffset(v, rng, e, &cache);
+  };
+  for (int64_t i = begin; i < end; i++, out += opt.walk_length) {
+    int prev = -1, v = i % num_nodes;
+    int len = 0;
+    out[len++] = g->vertex_index->vertex_table[v].node;
+    while (len < opt.walk_length) {
+      WeightedEdge e;
+      if (!step(v, e)) break;
+      if (second_order && prev != -1) {
+        // Rejection: at most a few proposals on average unless p or q are extreme
+        while (true) {
+          double r = coin(rng);
+          int x = e.idx;
+          if (r < min_prob) break;
+          double prob = x == prev ? return_prob : (g->HasEdgeByOffset(prev, x) ? 1.0 : out_prob);
+          if (r < prob) break;
+          if (!step(v, e)) break;
+        }
+      }
+      prev = v;
+      v = e.idx;
+      out[len++] = g->vertex_index->vertex_table[v].node;
+    }
+    std::fill(out + len, out + opt.walk_length, kWalkEnd);
+  }
+}
+
+static std::vector<float> MaxWeights(RadixGraph* g, uint32_t num_nodes, const WalkOptions& opt) {
+  std::vector<float> max_weight;
+  if (!opt.weighted) return max_weight;
+  max_weight.resize(num_nodes);
+  #pragma omp parallel for schedule(dynamic, 1024)
+  for (NodeID n = 0; n < num_nodes; n++) max_weight[n] = g->MaxWeightByOffset(n);
+  return max_weight;
+}
+
+std::vector<uint64_t> RandomWalks(RadixGraph* g, uint32_t num_nodes, const WalkOptions& opt) {
+  int64_t num_walks = (int64_t)num_nodes * opt.walks_per_vertex;
+  std::vector<uint64_t> walks(num_walks * opt.walk_length);
+  auto max_weight = MaxWeights(g, num_nodes, opt);
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (int64_t begin = 0; begin < num_walks; begin += kWalkBlock) {
+    GenerateWalks(g, num_nodes, opt, max_weight, begin, std::min(begin + kWalkBlock, num_walks),
+                  walks.data() + begin * opt.walk_length);
+  }
+  return walks;
+}
+
+bool RandomWalksToFile(RadixGraph* g, uint32_t num_nodes, const WalkOptions& opt, const std::string& path) {
+  FILE* f = fopen(path.c_str(), "w");
+  if (f == nullptr) return false;
+  int64_t num_walks = (int64_t)num_nodes * opt.walks_per_vertex;
+  auto max_weight = MaxWeights(g, num_nodes, opt);
+  // Generate and format a bounded number of blocks at a time, then write them in order
+  const int64_t blocks_per_chunk = 1024;
+  std::vector<std::string> text(blocks_per_chunk);
+  bool ok = true;
+  for (int64_t chunk = 0; chunk < num_walks && ok; chunk += blocks_per_chunk * kWalkBlock) {
+    #pragma omp parallel
+    {
+      std::vector<uint64_t> walks(kWalkBlock * opt.walk_length);
+      char buf[24];
+      #pragma omp for schedule(dynamic, 1)
+      for (int64_t b = 0; b < blocks_per_chunk; b++) {
+        int64_t begin = chunk + b * kWalkBlock, end = std::min(begin + kWalkBlock, num_walks);
+        text[b].clear();
+        if (begin >= num_walks) continue;
+        GenerateWalks(g, num_nodes, opt, max_weight, begin, end, walks.data());
+        for (int64_t i = 0; i < end - begin; i++) {
+          for (int j = 0; j < opt.walk_length && walks[i * opt.walk_length + j] != kWalkEnd; j++) {
+            if (j) text[b] += ' ';
+            text[b].append(buf, snprintf(buf, sizeof(buf), "%" PRIu64, walks[i * opt.walk_length + j]));
+          }
+          text[b] += '\n';
+        }
+      }
+    }
+    for (auto& t : text) ok = ok && fwrite(t.data(), 1, t.size(), f) == t.size();
+  }
+  return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,31 @@
+//
+// Random walk generation (uniform, weighted and node2vec)
+//
+
+#ifndef GRAPHINDEX_RANDOM_WALK_H
+#define GRAPHINDEX_RANDOM_WALK_H
+
+#include "benchmark.h"
+#include "../radixgraph.h"
+
+// Pads walks that reach a vertex without neighbours before walk_length
+const uint64_t kWalkEnd = UINT64_MAX;
+
+struct WalkOptions {
+  int walk_length = 80;        // vertices per walk, including the start
+  int walks_per_vertex = 10;
+  bool weighted = false;       // step with probability proportional to edge weights
+  double p = 1, q = 1;         // node2vec return and in-out parameters (p = q = 1: first-order walk)
+  uint64_t seed = 1;
+};
+
+// walks_per_vertex walks from every vertex offset; walk i starts at offset
+// i % num_nodes and occupies [i * walk_length, (i + 1) * walk_length) of the
+// result, as vertex IDs. Walks only depend on the options, not on the number
+// of threads.
+std::vector<uint64_t> RandomWalks(RadixGraph* g, uint32_t num_nodes, const WalkOptions& opt);
+// The same walks written to a text file, one line of space-separated vertex
+// IDs per walk; returns false if the file cannot be written
+bool RandomWalksToFile(RadixGraph* g, uint32_t num_nodes, const WalkOptions& opt, const std::string& path);
+
+#endif //GRAPHINDEX_RANDOM_WALK_H
@@ -44,7 +44,6 @@ execution order, leading to significant speedup on large diameter road networks.
     algorithms with GraphIt." The 18th International Symposium on Code Generation
     and Optimization (CGO), pages 158-170, 2020.
 */
-const WeightT kDistInf = std::numeric_limits<WeightT>::max() / 2;
 const size_t kMaxBin = std::numeric_limits<size_t>::max() / 2;
 const size_t kBinSizeThreshold = 1000;
 
@@ -16,6 +16,9 @@
 #include "pvector.h"
 #include "../radixgraph.h"
 
+// Distance of unreachable vertices
+const WeightT kDistInf = std::numeric_limits<WeightT>::max() / 2;
+
 inline void RelaxEdges(RadixGraph* g, int u, WeightT delta,
                 pvector<WeightT> &dist, std::vector<std::vector<int>> &local_bins) {
     std::vector<WeightedEdge> neighbours;
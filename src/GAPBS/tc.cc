@@ -15,81 +15,174 @@ Will count the number of triangles (cliques of size 3)
 Requires input graph:
   - to be undirected
   - no duplicate edges (or else will be counted as multiple triangles)
-  - neighborhoods are sorted by vertex identifiers
-
-Other than symmetrizing, the rest of the requirements are done by SquishCSR
-during graph building.
 
 This implementation reduces the search space by counting each triangle only
 once. A naive implementation will count the same triangle six times because
 each of the three vertices (u, v, w) will count it in both ways. To count
-a triangle only once, this implementation only counts a triangle if u > v > w.
-Once the remaining unexamined neighbors identifiers get too big, it can break
-out of the loop, but this requires that the neighbors to be sorted.
-
-Another optimization this implementation has is to relabel the vertices by
-degree. This is beneficial if the average degree is high enough and if the
-degree distribution is sufficiently non-uniform. To decide whether or not
-to relabel the graph, we use the heuristic in WorthRelabelling.
+a triangle only once, this implementation only counts a triangle if
+rank(u) > rank(v) > rank(w).
+
+Neighbour lists in RadixGraph are unsorted edge logs, so each of them is
+materialized only once (by BuildOrientedGraph) into a CSR buffer that keeps,
+for every vertex, the sorted ranks of its neighbours with smaller rank.
+Vertices are ranked by decreasing degree (i.e., relabelled by degree), which
+bounds the oriented out-degree of hubs and keeps intersections short. Sorted
+lists are intersected with a SIMD block merge, or by galloping when their
+sizes are skewed (see Intersect in tc.h).
 */
-std::vector<double> OrderedCount(RadixGraph* g, uint32_t num_vertices) {
-  size_t total = 0;
-  auto triangles_per_vertex = (std::atomic<uint32_t>*)malloc(sizeof(std::atomic<uint32_t>) * num_vertices);
+OrientedGraph BuildOrientedGraph(RadixGraph* g, uint32_t num_vertices) {
+  OrientedGraph og;
+  og.rank.resize(num_vertices);
+  std::vector<NodeID> order(num_vertices);
+  #pragma omp parallel for
+  for (NodeID n = 0; n < num_vertices; n++) order[n] = n;
+  std::sort(order.begin(), order.end(), [&](NodeID a, NodeID b) {
+    int da = g->vertex_index->vertex_table[a].deg, db = g->vertex_index->vertex_table[b].deg;
+    return da != db ? da > db : a < b;
+  });
+  #pragma omp parallel for
+  for (NodeID r = 0; r < num_vertices; r++) og.rank[order[r]] = r;
+
+  // Pass 1: count neighbours with smaller rank; pass 2: fill and sort them
+  og.offsets.assign(num_vertices + 1, 0);
   #pragma omp parallel
   {
-    auto triangles_u = 0u;
-    auto triangles_v = 0u;
-
+    std::vector<WeightedEdge> neighbours;
+    #pragma omp for schedule(dynamic, 256)
+    for (NodeID n = 0; n < num_vertices; n++) {
+      g->GetNeighboursByOffset(n, neighbours);
+      int cnt = 0;
+      for (auto e : neighbours) cnt += og.rank[e.idx] < og.rank[n];
+      og.offsets[og.rank[n] + 1] = cnt;
+    }
+  }
+  for (NodeID r = 0; r < num_vertices; r++) og.offsets[r + 1] += og.offsets[r];
+  og.neighbours.resize(og.offsets[num_vertices]);
+  #pragma omp parallel
+  {
+    std::vector<WeightedEdge> neighbours;
     #pragma omp for schedule(dynamic, 256)
     for (NodeID n = 0; n < num_vertices; n++) {
-        std::vector<WeightedEdge> u_neighbours;
-        g->GetNeighboursByOffset(n, u_neighbours);
-        std::sort(u_neighbours.begin(), u_neighbours.end(), [](WeightedEdge a, WeightedEdge b) {
-          return a.idx < b.idx;
-        });
-        for (auto e : u_neighbours) {
-            auto v = e.idx;
-            if (v > n) {
-                break;
-            }
-            auto it = u_neighbours.begin();
-            std::vector<WeightedEdge> v_neighbours;
-            g->GetNeighboursByOffset(v, v_neighbours);
-            std::sort(v_neighbours.begin(), v_neighbours.end(), [](WeightedEdge a, WeightedEdge b) {
-              return a.idx < b.idx;
-            });
-            for (auto e1 : v_neighbours) {
-                auto w = e1.idx;
-                if (w > v) {
-                    break;
-                }
-                while (it->idx < w) {
-                    it++;
-                }
-                if (w == it->idx) {
-                    triangles_u += 2;
-                    triangles_v += 2;
-                    triangles_per_vertex[e1.idx] += 2;
-                }
-            }
-            triangles_per_vertex[v] += triangles_v;
-            triangles_v = 0;
-        }
-        triangles_per_vertex[n] += triangles_u;
-        triangles_u = 0;
+      g->GetNeighboursByOffset(n, neighbours);
+      int u = og.rank[n];
+      int* out = og.neighbours.data() + og.offsets[u];
+      int cnt = 0;
+      for (auto e : neighbours) {
+        // Edges inserted after pass 1 are ignored
+        if (og.rank[e.idx] < u && og.offsets[u] + cnt < og.offsets[u + 1]) out[cnt++] = og.rank[e.idx];
+      }
+      std::sort(out, out + cnt);
+      // Drop duplicate edges, padding with -1 which never matches
+      int num_unique = std::unique(out, out + cnt) - out;
+      std::fill(out + num_unique, og.neighbours.data() + og.offsets[u + 1], -1);
+    }
+  }
+  return og;
+}
+
+std::vector<uint32_t> TrianglesPerVertex(RadixGraph* g, uint32_t num_vertices) {
+  OrientedGraph og = BuildOrientedGraph(g, num_vertices);
+  std::vector<std::atomic<uint32_t>> triangles_per_vertex(num_vertices);
+  #pragma omp parallel for schedule(dynamic, 256)
+  for (NodeID u = 0; u < num_vertices; u++) {
+    const int* u_begin = og.neighbours.data() + og.offsets[u];
+    size_t u_size = og.Size(u);
+    uint32_t triangles_u = 0;
+    for (size_t i = 0; i < u_size; i++) {
+      int v = u_begin[i];
+      uint32_t triangles_v = 0;
+      // Neighbours of v all have smaller ranks than v, so only u's neighbours before v can match
+      Intersect(u_begin, i, og.neighbours.data() + og.offsets[v], og.Size(v), [&](int w) {
+        triangles_v++;
+        triangles_per_vertex[w]++;
+      });
+      triangles_u += triangles_v;
+      if (triangles_v) triangles_per_vertex[v] += triangles_v;
     }
+    if (triangles_u) triangles_per_vertex[u] += triangles_u;
   }
 
+  std::vector<uint32_t> triangles(num_vertices);
+  #pragma omp parallel for
+  for (NodeID v = 0; v < num_vertices; v++) triangles[v] = triangles_per_vertex[og.rank[v]];
+  return triangles;
+}
+
+std::vector<double> OrderedCount(RadixGraph* g, uint32_t num_vertices) {
+  auto triangles_per_vertex = TrianglesPerVertex(g, num_vertices);
+
   std::vector<double> lcc_values(num_vertices);
   #pragma omp parallel for
   for (NodeID v = 0; v < num_vertices; v++) {
-      uint32_t degree = g->degree[v];
+      uint64_t degree = g->vertex_index->vertex_table[v].deg;
       uint64_t max_num_edges = degree * (degree - 1);
       if (max_num_edges != 0) {
-          lcc_values[v] = ((double) triangles_per_vertex[v]) / max_num_edges;
+          lcc_values[v] = 2.0 * triangles_per_vertex[v] / max_num_edges;
       } else {
           lcc_values[v] = 0.0;
       }
   }
   return lcc_values;
-}
\ No newline at end of file
+}
+
+
+DynamicTriangleCount::DynamicTriangleCount(RadixGraph* g, uint32_t num_vertices) : g_(g) {
+  triangles_per_vertex = TrianglesPerVertex(g, num_vertices);
+  for (auto t : triangles_per_vertex) num_triangles += t;
+  num_triangles /= 3;
+}
+
+void DynamicTriangleCount::UpdateTriangles(int u, int v, int delta) {
+  if (u == v) return;
+  auto sorted_ids = [&](int x, std::vector<WeightedEdge> &neighbours, std::vector<int> &ids) {
+    g_->GetNeighboursByOffset(x, neighbours);
+    ids.clear();
+    for (auto e : neighbours) {
+      if (e.idx != u && e.idx != v) ids.push_back(e.idx);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  };
+  sorted_ids(u, u_neighbours_, u_ids_);
+  sorted_ids(v, v_neighbours_, v_ids_);
+  int num_common = 0;
+  Intersect(u_ids_.data(), u_ids_.size(), v_ids_.data(), v_ids_.size(), [&](int w) {
+    triangles_per_vertex[w] += delta;
+    num_common++;
+  });
+  triangles_per_vertex[u] += delta * num_common;
+  triangles_per_vertex[v] += delta * num_common;
+  num_triangles += delta * num_common;
+}
+
+bool DynamicTriangleCount::InsertEdge(NodeID u, NodeID v, double weight) {
+  if (!g_->InsertUndirectedEdge(u, v, weight)) {
+    return false;
+  }
+  int u_idx = g_->vertex_index->RetrieveVertex(u)->idx, v_idx = g_->vertex_index->RetrieveVertex(v)->idx;
+  if ((int)triangles_per_vertex.size() < g_->vertex_index->cnt) triangles_per_vertex.resize(g_->vertex_index->cnt, 0);
+  UpdateTriangles(u_idx, v_idx, 1);
+  return true;
+}
+
+bool DynamicTriangleCount::DeleteEdge(NodeID u, NodeID v) {
+  if (!g_->DeleteUndirectedEdge(u, v)) {
+    return false;
+  }
+  int u_idx = g_->vertex_index->RetrieveVertex(u)->idx, v_idx = g_->vertex_index->RetrieveVertex(v)->idx;
+  UpdateTriangles(u_idx, v_idx, -1);
+  return true;
+}
+
+void DynamicTriangleCount::ApplyBatch(const std::vector<EdgeUpdate> &updates) {
+  for (auto &e : updates) {
+    if (e.deleted) DeleteEdge(e.src, e.des);
+    else InsertEdge(e.src, e.des, e.weight);
+  }
+}
+
+double DynamicTriangleCount::LCC(int v) const {
+  uint64_t degree = g_->vertex_index->vertex_table[v].deg;
+  uint64_t max_num_edges = degree * (degree - 1);
+  return max_num_edges != 0 ? 2.0 * triangles_per_vertex[v] / max_num_edges : 0.0;
+}
@@ -5,10 +5,116 @@
 #ifndef GRAPHINDEX_TC_H
 #define GRAPHINDEX_TC_H
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "benchmark.h"
 #include "pvector.h"
 #include "../radixgraph.h"
 
+// Lists whose sizes differ by more than this ratio are intersected by galloping
+const int kGallopRatio = 32;
+
+// Calls f(x) for every x in both sorted (duplicate-free) arrays a and b
+template <typename F>
+inline void Intersect(const int* a, size_t na, const int* b, size_t nb, F f) {
+  if (na > nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  if (na == 0) return;
+  size_t i = 0, j = 0;
+  if (na * kGallopRatio < nb) {
+    for (; i < na; i++) {
+      // Exponential search for the first b[j] >= a[i], then binary search
+      size_t bound = 1;
+      while (j + bound < nb && b[j + bound] < a[i]) bound <<= 1;
+      j = std::lower_bound(b + j + bound / 2, b + std::min(j + bound + 1, nb), a[i]) - b;
+      if (j == nb) break;
+      if (b[j] == a[i]) f(a[i]);
+    }
+    return;
+  }
+#ifdef __SSE2__
+  // Compare blocks of 4 x 4 elements, then advance the block with the smaller maximum
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+    __m128i eq = _mm_cmpeq_epi32(va, vb);
+    vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+    vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+    vb = _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, vb));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+    while (mask) {
+      f(a[i + __builtin_ctz(mask)]);
+      mask &= mask - 1;
+    }
+    int a_max = a[i + 3], b_max = b[j + 3];
+    if (a_max <= b_max) i += 4;
+    if (b_max <= a_max) j += 4;
+  }
+#endif
+  while (i < na && j < nb) {
+    if (a[i] < b[j]) i++;
+    else if (a[i] > b[j]) j++;
+    else f(a[i]), i++, j++;
+  }
+}
+
+// Degree-ordered, oriented snapshot of an undirected RadixGraph in CSR form:
+// vertex offset n is renamed to rank[n] (decreasing degree), and the sorted
+// list of rank u keeps only neighbours with smaller ranks (padded with -1)
+struct OrientedGraph {
+  std::vector<int> rank;
+  std::vector<int64_t> offsets;
+  std::vector<int> neighbours;
+
+  size_t Size(int u) const {
+    const int* begin = neighbours.data() + offsets[u];
+    size_t size = offsets[u + 1] - offsets[u];
+    while (size > 0 && begin[size - 1] == -1) size--;
+    return size;
+  }
+};
+
+OrientedGraph BuildOrientedGraph(RadixGraph* g, uint32_t num_vertices);
+
+// Number of triangles each vertex (by offset) belongs to
+std::vector<uint32_t> TrianglesPerVertex(RadixGraph* g, uint32_t num_vertices);
+
 std::vector<double> OrderedCount(RadixGraph* g, uint32_t num_vertices);
 
+// Maintains global and per-vertex triangle counts of an undirected RadixGraph
+// under edge updates, so that LCC stays fresh without recounting. Each update
+// is applied to both directions in the graph and only intersects the
+// neighbourhoods of its two endpoints. Updates must not run concurrently.
+class DynamicTriangleCount {
+ public:
+  uint64_t num_triangles = 0;
+  std::vector<uint32_t> triangles_per_vertex;
+
+  DynamicTriangleCount(RadixGraph* g, uint32_t num_vertices);
+
+  // Insert (or update the weight of) undirected edge (u, v); returns false if it already existed
+  bool InsertEdge(NodeID u, NodeID v, double weight);
+  // Delete undirected edge (u, v); returns false if it did not exist
+  bool DeleteEdge(NodeID u, NodeID v);
+  // Apply a batch of updates in order
+  void ApplyBatch(const std::vector<EdgeUpdate> &updates);
+  // Local clustering coefficient of the vertex at offset v
+  double LCC(int v) const;
+
+ private:
+  RadixGraph* g_;
+  std::vector<WeightedEdge> u_neighbours_, v_neighbours_;
+  std::vector<int> u_ids_, v_ids_;
+
+  // Add delta to the counts of all triangles closed by edge (u, v)
+  void UpdateTriangles(int u, int v, int delta);
+};
+
 #endif //GRAPHINDEX_TC_H
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2025 Haoxuan Xie
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "compressed_edges.h"
+
+CompressedEdges::CompressedEdges(const std::vector<WeightedEdge> &edges, bool quantize_weights) {
+    num = edges.size();
+    weight_mode = kUniform;
+    uniform_weight = num > 0 ? edges[0].weight : 0;
+    for (auto e : edges) {
+        if (e.weight != uniform_weight) {
+            weight_mode = quantize_weights && std::is_floating_point<EdgeWeight>::value ? kQuantized : kFull;
+            break;
+        }
+    }
+
+    std::vector<uint8_t> bytes;
+    std::vector<uint32_t> pos;
+    bytes.reserve(num * 2);
+    int prev = 0;
+    for (int i = 0; i < num; i++) {
+        if ((i & (kBlockSize - 1)) == 0) {
+            pos.push_back(bytes.size());
+            prev = 0;
+        }
+        uint32_t delta = edges[i].idx - prev;
+        prev = edges[i].idx;
+        while (delta >= 0x80) {
+            bytes.push_back((delta & 0x7f) | 0x80);
+            delta >>= 7;
+        }
+        bytes.push_back(delta);
+    }
+
+    size_t weight_bytes = weight_mode == kUniform ? 0 : (weight_mode == kQuantized ? sizeof(uint16_t) : sizeof(EdgeWeight)) * num;
+    // Weights start at the next multiple of alignof(EdgeWeight) (e.g., 8 for doubles after an odd number of blocks)
+    size_t weight_offset = (pos.size() * sizeof(uint32_t) + alignof(EdgeWeight) - 1) / alignof(EdgeWeight) * alignof(EdgeWeight);
+    num_bytes = weight_offset + weight_bytes + bytes.size();
+    data = new uint8_t[num_bytes];
+    block_pos = (uint32_t*)data;
+    std::copy(pos.begin(), pos.end(), block_pos);
+    weights = data + weight_offset;
+    if (weight_mode == kQuantized) {
+        auto w = (uint16_t*)weights;
+        for (int i = 0; i < num; i++) {
+            float w_f = edges[i].weight;
+            uint32_t bits;
+            std::memcpy(&bits, &w_f, sizeof(bits));
+            // Round to nearest even on the truncated mantissa bits
+            bits += 0x7fff + ((bits >> 16) & 1);
+            w[i] = bits >> 16;
+        }
+    }
+    else if (weight_mode == kFull) {
+        auto w = (EdgeWeight*)weights;
+        for (int i = 0; i < num; i++) w[i] = edges[i].weight;
+    }
+    stream = weights + weight_bytes;
+    std::copy(bytes.begin(), bytes.end(), (uint8_t*)stream);
+    max_weight = uniform_weight;
+    for (int i = 0; weight_mode != kUniform && i < num; i++) max_weight = std::max(max_weight, Weight(i));
+}
+
+CompressedEdges::~CompressedEdges() {
+    delete [] data;
+}
+
+void CompressedEdges::Decode(WeightedEdge* out) const {
+    ForEach([&](WeightedEdge e) { *out++ = e; });
+}
+
+WeightedEdge CompressedEdges::Get(int i) const {
+    int b = i / kBlockSize;
+    const uint8_t* p = stream + block_pos[b];
+    int idx = 0;
+    for (int j = b * kBlockSize; j <= i; j++) idx += ReadVarint(p);
+    return MakeEdge(idx, Weight(i));
+}
+
+bool CompressedEdges::Find(int idx, WeightedEdge &e) const {
+    if (num == 0) {
+        return false;
+    }
+    // Binary search the last block whose first offset is not larger than idx
+    int l = 0, r = NumBlocks() - 1;
+    while (l < r) {
+        int mid = (l + r + 1) >> 1;
+        const uint8_t* p = stream + block_pos[mid];
+        if (ReadVarint(p) <= idx) l = mid;
+        else r = mid - 1;
+    }
+    const uint8_t* p = stream + block_pos[l];
+    int cur = 0;
+    for (int j = l * kBlockSize; j < std::min(num, (l + 1) * kBlockSize); j++) {
+        cur += ReadVarint(p);
+        if (cur >= idx) {
+            if (cur > idx) return false;
+            e = MakeEdge(cur, Weight(j));
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t CompressedEdges::size() const {
+    return sizeof(CompressedEdges) + num_bytes;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2025 Haoxuan Xie
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef COMPRESSED_EDGES
+#define COMPRESSED_EDGES
+
+#include "optimized_trie.h"
+
+/* CompressedEdges:
+   - A frozen, read-optimized copy of the live edges of a vertex, built by RadixGraph::Compact();
+   - Destination offsets are sorted and delta-encoded as varints. Every kBlockSize edges start a new
+     block whose first offset is encoded in full, so an edge can be located by decoding one block only;
+   - Weights are dropped when all edges share one weight (always for unweighted builds), rounded to the
+     nearest bfloat16 (ties to even) when quantization is requested for floating-point weights, and
+     stored as EdgeWeight otherwise;
+   - Layout of data: [byte position of each block in the varint stream][padding to alignof(EdgeWeight)]
+     [weights][varint stream].
+*/
+class CompressedEdges {
+    public:
+        static const int kBlockSize = 64;
+        enum WeightMode : uint8_t { kUniform, kQuantized, kFull };
+
+        int num = 0;
+        WeightMode weight_mode = kUniform;
+        EdgeWeight uniform_weight = 0;
+        // The largest (stored) weight, bounding rejection sampling by weight
+        EdgeWeight max_weight = 0;
+
+        /*  CompressedEdges(): encode a neighbour list;
+            edges: the live edges of a vertex, sorted by destination offset;
+            quantize_weights: whether to round non-uniform weights to 16 bits. */
+        CompressedEdges(const std::vector<WeightedEdge> &edges, bool quantize_weights=false);
+        CompressedEdges(const CompressedEdges&) = delete;
+        ~CompressedEdges();
+
+        /*  ForEach(): decode edges in order of destination offsets and call f(WeightedEdge) on each. */
+        template <typename F>
+        void ForEach(F f) const {
+            const uint8_t* p = stream;
+            int prev = 0;
+            for (int i = 0; i < num; i++) {
+                if ((i & (kBlockSize - 1)) == 0) prev = 0;
+                prev += ReadVarint(p);
+                f(MakeEdge(prev, Weight(i)));
+            }
+        }
+        /*  ForEachInRange(): same as ForEach(), but only for the edges with weights in [lo, hi];
+            the weights of a block are tested first (in a branch-free loop), and blocks without a
+            match are skipped without decoding their offsets. */
+        template <typename F>
+        void ForEachInRange(double lo, double hi, F f) const {
+            if (weight_mode == kUniform) {
+                if (uniform_weight >= lo && uniform_weight <= hi) ForEach(f);
+                return;
+            }
+            for (int b = 0, begin = 0; begin < num; b++, begin += kBlockSize) {
+                int end = std::min(num, begin + kBlockSize);
+                uint64_t mask = InRange(begin, end, lo, hi);
+                if (!mask) continue;
+                end = begin + 64 - __builtin_clzll(mask);
+                const uint8_t* p = stream + block_pos[b];
+                int prev = 0;
+                for (int i = begin; i < end; i++) {
+                    prev += ReadVarint(p);
+                    if ((mask >> (i - begin)) & 1) f(MakeEdge(prev, Weight(i)));
+                }
+            }
+        }
+        /*  Decode(): decode all edges into out, which must have room for num edges. */
+        void Decode(WeightedEdge* out) const;
+        /*  Get(): decode the i-th edge (in order of destination offsets). */
+        WeightedEdge Get(int i) const;
+        /*  Find(): search the edge to a destination offset; returns false if it is not present. */
+        bool Find(int idx, WeightedEdge &e) const;
+        /*  size(): number of bytes used by the encoding. */
+        size_t size() const;
+
+    private:
+        uint8_t* data = nullptr;
+        uint32_t* block_pos = nullptr;
+        const uint8_t* weights = nullptr;
+        const uint8_t* stream = nullptr;
+        int num_bytes = 0;
+
+        static int ReadVarint(const uint8_t* &p) {
+            int x = *p & 0x7f;
+            for (int shift = 7; *p++ & 0x80; shift += 7) x |= (*p & 0x7f) << shift;
+            return x;
+        }
+
+        EdgeWeight Weight(int i) const {
+            if (weight_mode == kUniform) return uniform_weight;
+            if (weight_mode == kQuantized) {
+                uint32_t bits = (uint32_t)((const uint16_t*)weights)[i] << 16;
+                float w;
+                std::memcpy(&w, &bits, sizeof(w));
+                return w;
+            }
+            return ((const EdgeWeight*)weights)[i];
+        }
+
+        // Bit i - begin is set if the weight of edge i (non-uniform modes only) is in [lo, hi]
+        uint64_t InRange(int begin, int end, double lo, double hi) const {
+            uint64_t mask = 0;
+            if (weight_mode == kQuantized) {
+                auto w = (const uint16_t*)weights;
+                for (int i = begin; i < end; i++) {
+                    uint32_t bits = (uint32_t)w[i] << 16;
+                    float w_f;
+                    std::memcpy(&w_f, &bits, sizeof(w_f));
+                    mask |= (uint64_t)(w_f >= lo && w_f <= hi) << (i - begin);
+                }
+            }
+            else {
+                auto w = (const EdgeWeight*)weights;
+                for (int i = begin; i < end; i++) mask |= (uint64_t)(w[i] >= lo && w[i] <= hi) << (i - begin);
+            }
+            return mask;
+        }
+
+        int NumBlocks() const { return (num + kBlockSize - 1) / kBlockSize; }
+};
+
+#endif
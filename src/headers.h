@@ -32,6 +32,8 @@
 #include <queue>
 #include <stack>
 #include <thread>
+#include <mutex>
+#include <type_traits>
 #include <omp.h>
 #include <tbb/concurrent_vector.h>
 
@@ -40,9 +40,16 @@
                  current->mtx->set_bit_atomic(idx);
                  tmp = (DummyNode*)current->children[idx];
                  if (!tmp) {
-                     int i = cnt.fetch_add(1);
-                     tmp = &(*vertex_table.grow_by(1));
+                     // The offset is the slot grow_by() hands out. Concurrent insertions may get
+                     // their slots in any order, so cnt is advanced in slot order: every vertex
+                     // below cnt is initialized, and no vertex at or above it has been returned yet
+                     auto slot = vertex_table.grow_by(1);
+                     int i = slot - vertex_table.begin();
+                     tmp = &(*slot);
                      tmp->idx = i;
+                     tmp->node = id;
+                     while (cnt.load() != i) std::this_thread::yield();
+                     cnt.store(i + 1);
                      current->children[idx] = (uint64_t)tmp;
                  }
                  tmp->node = id;
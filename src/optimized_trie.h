@@ -62,19 +62,76 @@ class AtomicBitmap {
   static size_t bit_offset(size_t n) { return n & (kBitsPerWord - 1); }
 };
 
-typedef struct _weighted_edge;
-typedef struct _dummy_node;
+struct _weighted_edge;
+struct _dummy_node;
+class CompressedEdges;
+class EdgeIndex;
+
+/* EdgeWeight: the weight type of edges, selected at build time with one of
+   RG_WEIGHT_NONE / RG_WEIGHT_FLOAT (default) / RG_WEIGHT_DOUBLE / RG_WEIGHT_UINT16 (see the RG_WEIGHT CMake option);
+   with RG_WEIGHT_NONE no weight is stored and every edge has weight 1.
+*/
+#if defined(RG_WEIGHT_NONE)
+#define RG_UNWEIGHTED
+typedef float EdgeWeight;
+#elif defined(RG_WEIGHT_DOUBLE)
+typedef double EdgeWeight;
+#elif defined(RG_WEIGHT_UINT16)
+typedef uint16_t EdgeWeight;
+// 6-byte edges: the 2-byte alignment leaves idx unaligned in every other log entry, which
+// x86 loads absorb, in exchange for logs a quarter smaller than with float weights
+#pragma pack(push, 2)
+#else
+typedef float EdgeWeight;
+#endif
 
 /* WeightedEdge:
    - Represents a directed weighted edge;
-   - e.weight: when it is 0, this edge is a delete log; otherwise it represents the weight of the edge;
-   - e.idx: the offset (logical ID) of destination's vertex; vertex_table[e.idx] returns the DummyNode of the vertex.
+   - e.weight: the weight of the edge (a constant 1 for unweighted builds);
+   - e.idx: the offset (logical ID) of destination's vertex; vertex_table[e.idx] returns the DummyNode of the vertex;
+     in edge logs, its highest bit (kDeleteFlag) marks a delete log, so any weight (including 0) is representable.
+     Edges returned by neighbour reads never carry the flag.
 */
 typedef struct _weighted_edge {
-    float weight = 0;
+#ifdef RG_UNWEIGHTED
+    static constexpr EdgeWeight weight = 1;
+#else
+    EdgeWeight weight = 0;
+#endif
     int idx = -1; 
+
+    static const int kDeleteFlag = INT32_MIN;
+    bool deleted() const { return idx & kDeleteFlag; }
+    int des() const { return idx & ~kDeleteFlag; }
 } WeightedEdge;
 
+#if defined(RG_WEIGHT_UINT16)
+#pragma pack(pop)
+#endif
+
+/*  MakeEdge(): build an edge log to destination offset idx. */
+inline WeightedEdge MakeEdge(int idx, double weight, bool deleted=false) {
+    WeightedEdge e;
+#ifndef RG_UNWEIGHTED
+    e.weight = weight;
+#else
+    (void)weight;
+#endif
+    e.idx = deleted ? (idx | WeightedEdge::kDeleteFlag) : idx;
+    return e;
+}
+
+/* EdgeType: the label of an edge in a typed multigraph; type 0 is the default type of untyped operations. */
+typedef uint8_t EdgeType;
+
+/* TypedLog: the edges of one non-default type of a vertex; next, deg, frozen and index work as in DummyNode. */
+typedef struct _typed_log {
+    tbb::concurrent_vector<WeightedEdge> next;
+    std::atomic<int> deg = 0;
+    CompressedEdges* frozen = nullptr;
+    EdgeIndex* index = nullptr;
+} TypedLog;
+
 /* DummyNode:
    - Stores the information of a vertex;
    - N.node: the vertex ID of this DummyNode;
@@ -82,6 +139,10 @@ typedef struct _weighted_edge {
    - N.del_time: the deletion time of this vertex;
    - N.next: the edge array pointer;
    - N.deg: the degree of the vertex (stored for analytical tasks);
+   - N.frozen: the compressed live edges of the vertex as of the last RadixGraph::Compact(); N.next only logs updates after that;
+   - N.typed: the edges of types 1, 2, ... (see EdgeType), one TypedLog per type, allocated on the first typed insertion;
+     next, deg and frozen above hold the edges of type 0;
+   - N.index: the live destinations of a long log, kept by upsert-mode updates (see EdgeIndex in ``radixgraph.h``);
    Note that we do not store ``Size`` since it can be retrieved by next.size(); N.idx is stored for practical implementation but can be removed.
 */
 typedef struct _dummy_node {
@@ -89,6 +150,9 @@ typedef struct _dummy_node {
     int idx = -1, del_time = 0;
     tbb::concurrent_vector<WeightedEdge> next;
     std::atomic<int> deg;
+    CompressedEdges* frozen = nullptr;
+    std::atomic<TypedLog*> typed = nullptr;
+    EdgeIndex* index = nullptr;
 } DummyNode;
 
 class SORT {
@@ -13,19 +13,42 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <cstring>
+
 #include "radixgraph.h"
+#include "GAPBS/bfs.h"
+#include "GAPBS/sssp.h"
+
+template <typename Log>
+static bool LockedHasEdge(Log &log, int des, int num_vertices);
+template <typename Log>
+static void IndexEdge(Log &log, int des, bool live);
 
-bool RadixGraph::Insert(DummyNode* src, DummyNode* des, double weight) {
-    src->next.emplace_back(weight, des->idx);
+bool RadixGraph::Insert(DummyNode* src, DummyNode* des, double weight, bool deleted) {
+    src->next.push_back(MakeEdge(des->idx, weight, deleted));
     return true;
 }
 
 bool RadixGraph::InsertEdge(NodeID src, NodeID des, double weight) {
     DummyNode* src_ptr = vertex_index->RetrieveVertex(src, true);
     DummyNode* des_ptr = vertex_index->RetrieveVertex(des, true);
+    if (enable_upsert) {
+        vertex_lock->set_bit_atomic(src_ptr->idx);
+        bool exists = LockedHasEdge(*src_ptr, des_ptr->idx, vertex_index->cnt);
+        if (!exists) {
+            src_ptr->deg.fetch_add(1);
+            if (enable_query) degree[src_ptr->idx].fetch_add(1);
+            IndexEdge(*src_ptr, des_ptr->idx, true);
+        }
+        Insert(src_ptr, des_ptr, weight);
+        vertex_lock->clear_bit(src_ptr->idx);
+        if (wcc && !exists) UnionWCC(src_ptr->idx, des_ptr->idx);
+        return !exists;
+    }
     src_ptr->deg.fetch_add(1);
     if (enable_query) degree[src_ptr->idx].fetch_add(1);
     Insert(src_ptr, des_ptr, weight);
+    if (wcc) UnionWCC(src_ptr->idx, des_ptr->idx);
     return true;
 }
 
@@ -38,6 +61,13 @@ bool RadixGraph::UpdateEdge(NodeID src, NodeID des, double weight) {
     if (!des_ptr) {
         return false;
     }
+    if (enable_upsert) {
+        vertex_lock->set_bit_atomic(src_ptr->idx);
+        bool exists = LockedHasEdge(*src_ptr, des_ptr->idx, vertex_index->cnt);
+        if (exists) Insert(src_ptr, des_ptr, weight);
+        vertex_lock->clear_bit(src_ptr->idx);
+        return exists;
+    }
     Insert(src_ptr, des_ptr, weight);
     return true;
 }
@@ -51,112 +81,874 @@ bool RadixGraph::DeleteEdge(NodeID src, NodeID des) {
     if (!des_ptr) {
         return false;
     }
+    if (enable_upsert) {
+        vertex_lock->set_bit_atomic(src_ptr->idx);
+        bool exists = LockedHasEdge(*src_ptr, des_ptr->idx, vertex_index->cnt);
+        if (exists) {
+            src_ptr->deg.fetch_sub(1);
+            if (enable_query) degree[src_ptr->idx].fetch_sub(1);
+            IndexEdge(*src_ptr, des_ptr->idx, false);
+            Insert(src_ptr, des_ptr, 0, true);
+        }
+        vertex_lock->clear_bit(src_ptr->idx);
+        if (wcc && exists) wcc_stale = true;
+        return exists;
+    }
     src_ptr->deg.fetch_sub(1);
     if (enable_query) degree[src_ptr->idx].fetch_sub(1);
-    Insert(src_ptr, des_ptr, 0);
+    Insert(src_ptr, des_ptr, 0, true);
+    if (wcc) wcc_stale = true;
+    return true;
+}
+
+bool RadixGraph::HasEdge(NodeID src, NodeID des) {
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
+    if (!src_ptr) {
+        return false;
+    }
+    DummyNode* des_ptr = vertex_index->RetrieveVertex(des);
+    if (!des_ptr) {
+        return false;
+    }
+    return HasEdgeByOffset(src_ptr->idx, des_ptr->idx);
+}
+
+bool RadixGraph::InsertUndirectedEdge(NodeID u, NodeID v, double weight) {
+    bool exists = HasEdge(u, v);
+    if (exists) UpdateEdge(u, v, weight);
+    else InsertEdge(u, v, weight);
+    if (u != v) {
+        if (HasEdge(v, u)) UpdateEdge(v, u, weight);
+        else InsertEdge(v, u, weight);
+    }
+    return !exists;
+}
+
+bool RadixGraph::DeleteUndirectedEdge(NodeID u, NodeID v) {
+    if (!HasEdge(u, v)) {
+        return false;
+    }
+    DeleteEdge(u, v);
+    if (u != v && HasEdge(v, u)) DeleteEdge(v, u);
     return true;
 }
 
+// Whether an adjacency log (of a DummyNode or a TypedLog) holds a live edge to des
+template <typename Log>
+static bool LogHasEdge(const Log &log, int des) {
+    if (log.deg == 0) {
+        return false;
+    }
+    for (int i = (int)log.next.size() - 1; i >= 0; i--) {
+        auto e = log.next[i];
+        if (e.des() == des) {
+            // The latest log of this edge decides whether it is alive
+            return !e.deleted();
+        }
+    }
+    WeightedEdge e;
+    return log.frozen && log.frozen->Find(des, e);
+}
+
+bool RadixGraph::HasEdgeByOffset(int src, int des) {
+    return LogHasEdge(vertex_index->vertex_table[src], des);
+}
+
+TypedLog* RadixGraph::GetTypedLog(DummyNode* v, EdgeType type, bool create) {
+    TypedLog* logs = v->typed.load();
+    if (!logs && create) {
+        // Racing allocations are resolved by a CAS, the loser frees its copy
+        TypedLog* fresh = new TypedLog[num_edge_types - 1];
+        if (v->typed.compare_exchange_strong(logs, fresh)) logs = fresh;
+        else delete [] fresh;
+    }
+    return logs ? logs + (type - 1) : nullptr;
+}
+
+bool RadixGraph::InsertEdge(NodeID src, NodeID des, double weight, EdgeType type) {
+    if (type == 0) return InsertEdge(src, des, weight);
+    if (type >= num_edge_types) return false;
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src, true);
+    DummyNode* des_ptr = vertex_index->RetrieveVertex(des, true);
+    TypedLog* log = GetTypedLog(src_ptr, type, true);
+    if (enable_upsert) {
+        vertex_lock->set_bit_atomic(src_ptr->idx);
+        bool exists = LockedHasEdge(*log, des_ptr->idx, vertex_index->cnt);
+        if (!exists) {
+            log->deg.fetch_add(1);
+            IndexEdge(*log, des_ptr->idx, true);
+        }
+        log->next.push_back(MakeEdge(des_ptr->idx, weight));
+        vertex_lock->clear_bit(src_ptr->idx);
+        return !exists;
+    }
+    log->deg.fetch_add(1);
+    log->next.push_back(MakeEdge(des_ptr->idx, weight));
+    return true;
+}
+
+bool RadixGraph::UpdateEdge(NodeID src, NodeID des, double weight, EdgeType type) {
+    if (type == 0) return UpdateEdge(src, des, weight);
+    if (type >= num_edge_types) return false;
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
+    DummyNode* des_ptr = vertex_index->RetrieveVertex(des);
+    if (!src_ptr || !des_ptr) {
+        return false;
+    }
+    TypedLog* log = GetTypedLog(src_ptr, type, !enable_upsert);
+    if (!log) {
+        return false;
+    }
+    if (enable_upsert) {
+        vertex_lock->set_bit_atomic(src_ptr->idx);
+        bool exists = LockedHasEdge(*log, des_ptr->idx, vertex_index->cnt);
+        if (exists) log->next.push_back(MakeEdge(des_ptr->idx, weight));
+        vertex_lock->clear_bit(src_ptr->idx);
+        return exists;
+    }
+    log->next.push_back(MakeEdge(des_ptr->idx, weight));
+    return true;
+}
+
+bool RadixGraph::DeleteEdge(NodeID src, NodeID des, EdgeType type) {
+    if (type == 0) return DeleteEdge(src, des);
+    if (type >= num_edge_types) return false;
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
+    DummyNode* des_ptr = vertex_index->RetrieveVertex(des);
+    if (!src_ptr || !des_ptr) {
+        return false;
+    }
+    TypedLog* log = GetTypedLog(src_ptr, type, !enable_upsert);
+    if (!log) {
+        return false;
+    }
+    if (enable_upsert) {
+        vertex_lock->set_bit_atomic(src_ptr->idx);
+        bool exists = LockedHasEdge(*log, des_ptr->idx, vertex_index->cnt);
+        if (exists) {
+            log->deg.fetch_sub(1);
+            IndexEdge(*log, des_ptr->idx, false);
+            log->next.push_back(MakeEdge(des_ptr->idx, 0, true));
+        }
+        vertex_lock->clear_bit(src_ptr->idx);
+        return exists;
+    }
+    log->deg.fetch_sub(1);
+    log->next.push_back(MakeEdge(des_ptr->idx, 0, true));
+    return true;
+}
+
+bool RadixGraph::HasEdge(NodeID src, NodeID des, EdgeType type) {
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
+    if (!src_ptr) {
+        return false;
+    }
+    DummyNode* des_ptr = vertex_index->RetrieveVertex(des);
+    if (!des_ptr) {
+        return false;
+    }
+    return HasEdgeByOffset(src_ptr->idx, des_ptr->idx, type);
+}
+
+bool RadixGraph::HasEdgeByOffset(int src, int des, EdgeType type) {
+    if (type == 0) return HasEdgeByOffset(src, des);
+    if (type >= num_edge_types) return false;
+    TypedLog* log = GetTypedLog(&vertex_index->vertex_table[src], type, false);
+    return log && LogHasEdge(*log, des);
+}
+
 bool RadixGraph::GetNeighbours(NodeID src, std::vector<WeightedEdge> &neighbours, int timestamp) {
     DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
     if (!src_ptr) {
         return false;
     }
-    return GetNeighbours(src_ptr->idx, neighbours, timestamp);
+    return GetNeighboursByOffset(src_ptr->idx, neighbours, timestamp);
 }
 
 bool RadixGraph::GetNeighboursByOffset(int src, std::vector<WeightedEdge> &neighbours, int timestamp) {
+    static thread_local DedupScratch scratch;
+    return GetNeighboursByOffset(src, neighbours, scratch, timestamp);
+}
+
+bool RadixGraph::GetNeighboursByOffset(int src, std::vector<WeightedEdge> &neighbours, DedupScratch &scratch, int timestamp) {
     auto& src_ptr = vertex_index->vertex_table[src];
-    int num = 0, k = 0;
-    int thread_id = omp_get_thread_num(), cnt = timestamp == -1 ? src_ptr.next.size() : timestamp, deg = src_ptr.deg;
-    neighbours.resize(deg);
+    CompressedEdges* frozen = src_ptr.frozen;
+    int num = 0, num_frozen = frozen ? frozen->num : 0;
+    int cnt = timestamp == -1 ? src_ptr.next.size() : timestamp, deg = src_ptr.deg;
+    if (num_frozen + cnt == deg) {
+        // Edge num = log num, every log is an insertion and there is nothing to deduplicate
+        neighbours.resize(deg);
+        if (frozen) frozen->Decode(neighbours.data()), num = num_frozen;
+        for (int i = 0; i < cnt; i++) {
+            auto e = src_ptr.next[i];
+            if (!e.deleted()) neighbours[num++] = e;
+        }
+        neighbours.resize(num);
+        return true;
+    }
+    scratch.Begin(cnt, vertex_index->cnt);
+    neighbours.resize(std::max(deg, 0));
+    bool materialized = false;
     for (int i = cnt - 1; i >= 0; i--) {
         auto e = src_ptr.next[i];
-        if (!bitmap[thread_id]->get_bit(e.idx)) {
-            if (e.weight != 0) { // Insert or Update
+        if (!scratch.TestAndSet(e.des())) {
+            if (!e.deleted()) { // Insert or Update
                 // Have not found a previous log for this edge, thus this edge is the latest
+                if ((size_t)num == neighbours.size()) neighbours.resize(num + 1);
                 neighbours[num++] = e;
             }
-            bitmap[thread_id]->set_bit(e.idx);
         }
-        if (deg - num == i) {
-            // Edge num = log num, all previous logs are materialized
+        if (deg - num == i + num_frozen) {
+            // Edge num = log num, all previous logs (and the frozen edges) are materialized
             for (int j = i - 1; j >= 0; j--) {
                 neighbours[num++] = src_ptr.next[j];
             }
-            k = i;
+            if (frozen) frozen->Decode(neighbours.data() + num), num += num_frozen;
+            materialized = true;
             break;
         }
     }
-    for (int i = k; i < cnt; i++) {
-        bitmap[thread_id]->clear_bit(src_ptr.next[i].idx);
+    if (!materialized && frozen) {
+        // Frozen edges are live unless a later log has updated or deleted them
+        frozen->ForEach([&](WeightedEdge e) {
+            if (!scratch.Test(e.idx)) {
+                if ((size_t)num == neighbours.size()) neighbours.resize(num + 1);
+                neighbours[num++] = e;
+            }
+        });
     }
+    scratch.End();
+    neighbours.resize(num);
 
     return true;
 }
 
-std::vector<uint64_t> RadixGraph::BFS(NodeID src) {
-    std::queue<int> Q;
-    AtomicBitmap vis(vertex_index->cnt);
-    vis.reset();
-    auto src_ptr = vertex_index->RetrieveVertex(src);
-    vis.set_bit(src_ptr->idx);
-    Q.push(src_ptr->idx);
-    std::vector<uint64_t> res;
-    while (!Q.empty()) {
-        auto u = Q.front();
-        Q.pop();
-        res.push_back(vertex_index->vertex_table[u].node);
+bool RadixGraph::GetNeighbours(NodeID src, std::vector<WeightedEdge> &neighbours, const EdgeFilter &filter, int timestamp) {
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
+    if (!src_ptr) {
+        return false;
+    }
+    return GetNeighboursByOffset(src_ptr->idx, neighbours, filter, timestamp);
+}
+
+// Filtered read of an adjacency log (of a DummyNode or a TypedLog)
+template <typename Log>
+static void ReadLog(const Log &log, int num_vertices, std::vector<WeightedEdge> &neighbours, const EdgeFilter &filter, int timestamp) {
+    static thread_local DedupScratch scratch;
+    CompressedEdges* frozen = log.frozen;
+    int num_frozen = frozen ? frozen->num : 0;
+    int cnt = timestamp == -1 ? log.next.size() : timestamp, deg = log.deg;
+    auto emit = [&](WeightedEdge e) {
+        if (filter.Match(e)) neighbours.push_back(e);
+    };
+    if (num_frozen + cnt == deg) {
+        // Every log is an insertion and there is nothing to deduplicate
+        if (frozen) frozen->ForEachInRange(filter.min_weight, filter.max_weight, emit);
+        for (int i = 0; i < cnt; i++) {
+            auto e = log.next[i];
+            if (!e.deleted()) emit(e);
+        }
+        return;
+    }
+    // Stale logs must be marked whether or not the latest one matches
+    scratch.Begin(cnt, num_vertices);
+    for (int i = cnt - 1; i >= 0; i--) {
+        auto e = log.next[i];
+        if (!scratch.TestAndSet(e.des()) && !e.deleted()) emit(e);
+    }
+    if (frozen) {
+        frozen->ForEachInRange(filter.min_weight, filter.max_weight, [&](WeightedEdge e) {
+            if (!scratch.Test(e.idx)) emit(e);
+        });
+    }
+    scratch.End();
+}
+
+// Existence check of upsert-mode updates, under the vertex lock; long logs get an EdgeIndex instead of a scan
+template <typename Log>
+static bool LockedHasEdge(Log &log, int des, int num_vertices) {
+    if (!log.index) {
+        if ((int)log.next.size() <= EdgeIndex::kMinLog) return LogHasEdge(log, des);
         std::vector<WeightedEdge> neighbours;
-        GetNeighboursByOffset(u, neighbours);
-        for (auto e : neighbours) {
-            if (!vis.get_bit(e.idx)) {
-                vis.set_bit(e.idx);
-                Q.push(e.idx);
+        ReadLog(log, num_vertices, neighbours, EdgeFilter(), -1);
+        log.index = new EdgeIndex(neighbours);
+    }
+    return log.index->Contains(des);
+}
+
+// Records an upserted (live) or deleted edge in the index of the log, if it has one
+template <typename Log>
+static void IndexEdge(Log &log, int des, bool live) {
+    if (!log.index) return;
+    if (live) log.index->Insert(des);
+    else log.index->Erase(des);
+}
+
+bool RadixGraph::GetNeighboursByOffset(int src, std::vector<WeightedEdge> &neighbours, const EdgeFilter &filter, int timestamp) {
+    neighbours.clear();
+    auto& src_ptr = vertex_index->vertex_table[src];
+    if (filter.type == 0) {
+        ReadLog(src_ptr, vertex_index->cnt, neighbours, filter, timestamp);
+        return true;
+    }
+    if (filter.type >= num_edge_types) {
+        return false;
+    }
+    TypedLog* log = GetTypedLog(&src_ptr, filter.type, false);
+    if (log) ReadLog(*log, vertex_index->cnt, neighbours, filter, timestamp);
+    return true;
+}
+
+bool RadixGraph::GetNeighbourByOffset(int src, int k, WeightedEdge &e, NeighbourCache *cache) {
+    auto& src_ptr = vertex_index->vertex_table[src];
+    CompressedEdges* frozen = src_ptr.frozen;
+    int num_frozen = frozen ? frozen->num : 0, cnt = src_ptr.next.size();
+    if (num_frozen + cnt == src_ptr.deg) {
+        if (k >= num_frozen + cnt) {
+            return false;
+        }
+        e = k < num_frozen ? frozen->Get(k) : src_ptr.next[k - num_frozen];
+        if (!e.deleted()) {
+            return true;
+        }
+    }
+    static thread_local NeighbourCache local;
+    if (!cache) {
+        cache = &local;
+        cache->src = -1;
+    }
+    if (cache->src != src) {
+        GetNeighboursByOffset(src, cache->neighbours);
+        cache->src = src;
+    }
+    if ((size_t)k >= cache->neighbours.size()) {
+        return false;
+    }
+    e = cache->neighbours[k];
+    return true;
+}
+
+bool RadixGraph::GetRandomNeighbour(NodeID src, std::mt19937_64 &rng, WeightedEdge &e, bool weighted) {
+    DummyNode* src_ptr = vertex_index->RetrieveVertex(src);
+    if (!src_ptr || src_ptr->idx < 0) {
+        return false;
+    }
+    return weighted ? GetWeightedRandomNeighbourByOffset(src_ptr->idx, rng, e) : GetRandomNeighbourByOffset(src_ptr->idx, rng, e);
+}
+
+bool RadixGraph::GetRandomNeighbourByOffset(int src, std::mt19937_64 &rng, WeightedEdge &e, NeighbourCache *cache) {
+    int deg = vertex_index->vertex_table[src].deg;
+    if (deg <= 0) {
+        return false;
+    }
+    return GetNeighbourByOffset(src, rng() % deg, e, cache);
+}
+
+bool RadixGraph::GetWeightedRandomNeighbourByOffset(int src, std::mt19937_64 &rng, WeightedEdge &e, double max_weight,
+                                                    NeighbourCache *cache) {
+    if (max_weight <= 0) max_weight = MaxWeightByOffset(src);
+    if (max_weight <= 0) {
+        return GetRandomNeighbourByOffset(src, rng, e, cache);
+    }
+    std::uniform_real_distribution<double> coin(0, max_weight);
+    // Expected max_weight / (mean weight) trials; give up on pathological bounds and sample exactly
+    for (int trial = 0; trial < 256; trial++) {
+        if (!GetRandomNeighbourByOffset(src, rng, e, cache)) {
+            return false;
+        }
+        if (coin(rng) < e.weight) {
+            return true;
+        }
+    }
+    static thread_local NeighbourCache local;
+    if (!cache) {
+        cache = &local;
+        cache->src = -1;
+    }
+    if (cache->src != src) {
+        GetNeighboursByOffset(src, cache->neighbours);
+        cache->src = src;
+    }
+    const std::vector<WeightedEdge>& neighbours = cache->neighbours;
+    double total = 0;
+    for (auto x : neighbours) total += x.weight;
+    if (neighbours.empty()) {
+        return false;
+    }
+    double r = std::uniform_real_distribution<double>(0, total)(rng);
+    for (auto x : neighbours) {
+        e = x;
+        if ((r -= x.weight) < 0) break;
+    }
+    return true;
+}
+
+double RadixGraph::MaxWeightByOffset(int src) {
+    auto& src_ptr = vertex_index->vertex_table[src];
+    double max_weight = src_ptr.frozen ? (double)src_ptr.frozen->max_weight : 0;
+    int cnt = src_ptr.next.size();
+    for (int i = 0; i < cnt; i++) max_weight = std::max(max_weight, (double)src_ptr.next[i].weight);
+    return max_weight;
+}
+
+void RadixGraph::EnableOnlineWCC() {
+    if (!wcc) wcc = new ConcurrentUnionFind(CAP_DUMMY_NODES);
+    wcc_stale = true;
+    RebuildWCC();
+}
+
+void RadixGraph::UnionWCC(int u, int v) {
+    std::shared_lock<std::shared_mutex> lock(wcc_mtx);
+    wcc->Union(u, v);
+}
+
+void RadixGraph::RebuildWCC() {
+    std::unique_lock<std::shared_mutex> lock(wcc_mtx);
+    // Clear the flag first, so that deletions during the rebuild mark it stale again
+    if (!wcc_stale.exchange(false)) return;
+    // Unions wait for the rebuild, so only offsets below cnt have ever been linked: an insertion either
+    // appended its edge before the scan reaches its source, or links it right after the rebuild
+    int n = vertex_index->cnt;
+    wcc->Reset(n);
+    #pragma omp parallel
+    {
+        std::vector<WeightedEdge> neighbours;
+        #pragma omp for schedule(dynamic, 256)
+        for (int i = 0; i < n; i++) {
+            GetNeighboursByOffset(i, neighbours);
+            for (auto e : neighbours) wcc->Union(i, e.idx);
+        }
+    }
+}
+
+int RadixGraph::GetComponent(NodeID v) {
+    DummyNode* v_ptr = vertex_index->RetrieveVertex(v);
+    if (!v_ptr) {
+        return -1;
+    }
+    return GetComponentByOffset(v_ptr->idx);
+}
+
+int RadixGraph::GetComponentByOffset(int v) {
+    if (!wcc) {
+        return -1;
+    }
+    if (wcc_stale) RebuildWCC();
+    std::shared_lock<std::shared_mutex> lock(wcc_mtx);
+    return wcc->Find(v);
+}
+
+bool RadixGraph::Connected(NodeID u, NodeID v) {
+    int cu = GetComponent(u);
+    return cu != -1 && cu == GetComponent(v);
+}
+
+void RadixGraph::Compact(bool quantize_weights) {
+    int n = vertex_index->cnt;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < n; i++) {
+        auto& v = vertex_index->vertex_table[i];
+        if (v.next.empty()) continue;
+        std::vector<WeightedEdge> neighbours;
+        GetNeighboursByOffset(i, neighbours);
+        std::sort(neighbours.begin(), neighbours.end(), [](WeightedEdge a, WeightedEdge b) {
+            return a.idx < b.idx;
+        });
+        if (v.frozen) delete v.frozen;
+        v.frozen = neighbours.empty() ? nullptr : new CompressedEdges(neighbours, quantize_weights);
+        tbb::concurrent_vector<WeightedEdge>().swap(v.next);
+        v.deg = neighbours.size();
+        if (enable_query) degree[i] = neighbours.size();
+    }
+    if (num_edge_types == 1) return;
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i = 0; i < n; i++) {
+        TypedLog* logs = vertex_index->vertex_table[i].typed;
+        if (!logs) continue;
+        std::vector<WeightedEdge> neighbours;
+        EdgeFilter filter;
+        for (int t = 1; t < num_edge_types; t++) {
+            TypedLog& log = logs[t - 1];
+            if (log.next.empty()) continue;
+            filter.type = t;
+            GetNeighboursByOffset(i, neighbours, filter);
+            std::sort(neighbours.begin(), neighbours.end(), [](WeightedEdge a, WeightedEdge b) {
+                return a.idx < b.idx;
+            });
+            if (log.frozen) delete log.frozen;
+            log.frozen = neighbours.empty() ? nullptr : new CompressedEdges(neighbours, quantize_weights);
+            tbb::concurrent_vector<WeightedEdge>().swap(log.next);
+            log.deg = neighbours.size();
+        }
+    }
+}
+
+/* RadixHeap: a monotone min-priority queue of (distance, offset) pairs [1], for Dijkstra searches whose
+   popped distances never decrease. Non-negative doubles are ordered like their bit patterns, so keys are
+   kept as integers: bucket i > 0 holds the keys whose highest bit differing from the last popped key is
+   bit i - 1, and bucket 0 the keys equal to it. Pushes are O(1); a pop that finds bucket 0 empty moves the
+   first non-empty bucket down around its minimum, and every key moves down at most 64 times.
+   [1] Ravindra K. Ahuja, Kurt Mehlhorn, James Orlin, and Robert E. Tarjan. "Faster Algorithms for the
+       Shortest Path Problem" Journal of the ACM, 37(2):213-223, 1990.
+*/
+struct RadixHeap {
+    std::vector<std::pair<uint64_t, int>> buckets[65];
+    uint64_t last = 0;
+    size_t size = 0;
+
+    static uint64_t Key(double d) {
+        uint64_t k;
+        memcpy(&k, &d, sizeof(k));
+        return k;
+    }
+
+    static int Bucket(uint64_t k, uint64_t last) {
+        return k == last ? 0 : 64 - __builtin_clzll(k ^ last);
+    }
+
+    void Clear() {
+        for (auto& b : buckets) b.clear();
+        last = 0;
+        size = 0;
+    }
+
+    bool Empty() const { return size == 0; }
+
+    // d must be no less than the last popped distance
+    void Push(double d, int idx) {
+        uint64_t k = Key(d);
+        buckets[Bucket(k, last)].emplace_back(k, idx);
+        size++;
+    }
+
+    // The pair with the smallest distance
+    std::pair<double, int> Top() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) i++;
+            uint64_t new_last = buckets[i][0].first;
+            for (auto& x : buckets[i]) new_last = std::min(new_last, x.first);
+            for (auto& x : buckets[i]) buckets[Bucket(x.first, new_last)].push_back(x);
+            buckets[i].clear();
+            last = new_last;
+        }
+        double d;
+        memcpy(&d, &buckets[0].back().first, sizeof(d));
+        return {d, buckets[0].back().second};
+    }
+
+    std::pair<double, int> Pop() {
+        auto top = Top();
+        buckets[0].pop_back();
+        size--;
+        return top;
+    }
+};
+
+// Visited marks that are cleared by bumping the epoch, so that small searches do not pay for the whole vertex set
+struct TraversalScratch {
+    std::vector<uint32_t> stamp;
+    uint32_t epoch = 0;
+    std::vector<int> queue;
+    RadixHeap heap;
+    std::vector<WeightedEdge> neighbours;
+
+    void Begin(size_t num_vertices) {
+        if (stamp.size() < num_vertices) stamp.resize(num_vertices, 0);
+        if (++epoch == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+        queue.clear();
+        heap.Clear();
+    }
+
+    // Mark an offset as visited; returns true if it has been visited before
+    bool TestAndSet(int idx) {
+        if (stamp[idx] == epoch) return true;
+        stamp[idx] = epoch;
+        return false;
+    }
+};
+
+static long long CountEdges(RadixGraph* g, int num_vertices) {
+    long long num_edges = 0;
+    #pragma omp parallel for reduction(+:num_edges)
+    for (int i = 0; i < num_vertices; i++) num_edges += g->vertex_index->vertex_table[i].deg;
+    return num_edges;
+}
+
+std::vector<uint64_t> RadixGraph::BFS(NodeID src, bool directed) {
+    std::vector<uint64_t> res;
+    auto src_ptr = vertex_index->RetrieveVertex(src);
+    if (src_ptr == nullptr || src_ptr->idx < 0) return res;
+    static thread_local TraversalScratch scratch;
+    int num_vertices = vertex_index->cnt;
+    scratch.Begin(num_vertices);
+    auto& Q = scratch.queue;
+    scratch.TestAndSet(src_ptr->idx);
+    Q.push_back(src_ptr->idx);
+    long long scanned = 0;
+    for (size_t head = 0; head < Q.size(); head++) {
+        GetNeighboursByOffset(Q[head], scratch.neighbours);
+        scanned += scratch.neighbours.size();
+        if (enable_query && scanned > scan_budget) {
+            // A large search: continue in parallel from the vertices visited so far, whose
+            // marks are copied into the parent array in the same pass that counts the edges.
+            // Top-down only (alpha = 1, and more edges than can be scouted) unless the graph
+            // is symmetric.
+            const std::vector<uint32_t>& stamp = scratch.stamp;
+            const uint32_t epoch = scratch.epoch;
+            pvector<NodeID> parent(num_vertices);
+            long long num_edges = 0;
+            #pragma omp parallel for reduction(+:num_edges)
+            for (int i = 0; i < num_vertices; i++) {
+                parent[i] = stamp[i] == epoch ? i : -1;
+                num_edges += vertex_index->vertex_table[i].deg;
             }
+            std::vector<int> frontier(Q.begin() + head, Q.end());
+            long long scout_count = 0;
+            for (int u : frontier) scout_count += degree[u];
+            if (directed) DOBFSFrom(this, parent, frontier, num_vertices, INT_MAX, scout_count, 1);
+            else DOBFSFrom(this, parent, frontier, num_vertices, num_edges, scout_count);
+            for (int i = 0; i < num_vertices; i++) {
+                if (parent[i] != (NodeID)-1) res.push_back(vertex_index->vertex_table[i].node);
+            }
+            return res;
+        }
+        for (auto e : scratch.neighbours) {
+            if (!scratch.TestAndSet(e.idx)) Q.push_back(e.idx);
         }
     }
+    res.reserve(Q.size());
+    for (int u : Q) res.push_back(vertex_index->vertex_table[u].node);
     return res;
 }
 
 std::vector<double> RadixGraph::SSSP(NodeID src) {
-    std::vector<double> dist;
-    dist.assign(vertex_index->cnt, 1e9);
+    DistanceArray res;
+    SSSP(src, res);
+    return std::move(res.dist);
+}
+
+void RadixGraph::SSSP(NodeID src, DistanceArray& res) {
+    int num_vertices = vertex_index->cnt;
+    auto& dist = res.dist;
+    if (res.reached_all) {
+        dist.assign(num_vertices, 1e9);
+        res.reached_all = false;
+    }
+    else {
+        for (int v : res.reached) dist[v] = 1e9;
+        dist.resize(num_vertices, 1e9);
+    }
+    res.reached.clear();
     auto u = vertex_index->RetrieveVertex(src);
-    std::priority_queue<std::pair<double, int>> Q;
+    if (u == nullptr || u->idx < 0) return;
+    static thread_local TraversalScratch scratch;
+    scratch.Begin(0);
+    auto& Q = scratch.heap;
     dist[u->idx] = 0;
-    Q.emplace(0, u->idx);
-    while (!Q.empty()) {
-        auto v = Q.top().second;
-        Q.pop();
-        std::vector<WeightedEdge> neighbours;
-        GetNeighboursByOffset(v, neighbours);
-        for (auto e : neighbours) {
+    res.reached.push_back(u->idx);
+    Q.Push(0, u->idx);
+    long long scanned = 0;
+    double weight_sum = 0;
+    while (!Q.Empty()) {
+        auto [d, v] = Q.Pop();
+        if (d > dist[v]) continue;
+        GetNeighboursByOffset(v, scratch.neighbours);
+        scanned += scratch.neighbours.size();
+        if (scanned > scan_budget) {
+            // A large search: restart with delta-stepping, with delta set to the mean weight seen so far
+            WeightT delta = weight_sum > 0 ? weight_sum / (scanned - scratch.neighbours.size()) : 1.0;
+            if (!(delta > 0)) delta = 1.0;
+            auto par = DeltaStep(this, src, delta, num_vertices, CountEdges(this, num_vertices) + 1);
+            for (int i = 0; i < num_vertices; i++) {
+                dist[i] = par[i] >= std::numeric_limits<WeightT>::max() / 4 ? 1e9 : par[i];
+            }
+            res.reached_all = true;
+            return;
+        }
+        for (auto e : scratch.neighbours) {
             auto w = e.idx;
+            weight_sum += e.weight;
             if (dist[v] + e.weight < dist[w]) {
+                if (dist[w] == 1e9) res.reached.push_back(w);
                 dist[w] = dist[v] + e.weight;
-                Q.emplace(-dist[w], w);
+                Q.Push(dist[w], w);
             }
         }
     }
-    return dist;
 }
 
-RadixGraph::RadixGraph(int d, std::vector<int> _num_children, bool _enable_query) {
+// State of one direction of a bidirectional search, with per-thread reusable arrays cleared by bumping the epoch
+struct SearchSide {
+    std::vector<uint32_t> stamp;
+    std::vector<double> dist;
+    std::vector<int> parent;
+    uint32_t epoch = 0;
+    std::vector<int> frontier, next;
+    RadixHeap heap;
+
+    void Begin(size_t num_vertices) {
+        if (stamp.size() < num_vertices) {
+            stamp.resize(num_vertices, 0);
+            dist.resize(num_vertices);
+            parent.resize(num_vertices);
+        }
+        if (++epoch == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+        frontier.clear();
+        heap.Clear();
+    }
+
+    bool Seen(int idx) const {
+        return stamp[idx] == epoch;
+    }
+
+    double Dist(int idx) const {
+        return Seen(idx) ? dist[idx] : 1e9;
+    }
+
+    void Set(int idx, double d, int p) {
+        stamp[idx] = epoch;
+        dist[idx] = d;
+        parent[idx] = p;
+    }
+};
+
+double RadixGraph::ShortestPath(NodeID s, NodeID t, std::vector<uint64_t>* path, RadixGraph* reverse, bool unweighted) {
+#ifdef RG_UNWEIGHTED
+    unweighted = true;
+#endif
+    if (path) path->clear();
+    auto s_ptr = vertex_index->RetrieveVertex(s), t_ptr = vertex_index->RetrieveVertex(t);
+    if (s_ptr == nullptr || t_ptr == nullptr || s_ptr->idx < 0 || t_ptr->idx < 0) return 1e9;
+    static thread_local SearchSide sides[2];
+    static thread_local std::vector<WeightedEdge> neighbours;
+    int num_vertices = vertex_index->cnt;
+    sides[0].Begin(num_vertices);
+    sides[1].Begin(num_vertices);
+    // Edges of u along the given direction, as offsets of this graph
+    auto expand = [&](int dir, int u) {
+        if (dir == 0 || reverse == nullptr) {
+            GetNeighboursByOffset(u, neighbours);
+            return;
+        }
+        neighbours.clear();
+        auto r = reverse->vertex_index->RetrieveVertex(vertex_index->vertex_table[u].node);
+        if (r == nullptr || r->idx < 0) return;
+        reverse->GetNeighboursByOffset(r->idx, neighbours);
+        int cnt = 0;
+        for (auto e : neighbours) {
+            auto v = vertex_index->RetrieveVertex(reverse->vertex_index->vertex_table[e.des()].node);
+            if (v == nullptr || v->idx < 0) continue;
+            neighbours[cnt] = e;
+            neighbours[cnt++].idx = v->idx;
+        }
+        neighbours.resize(cnt);
+    };
+
+    double best = 1e9;
+    int meet = -1;
+    sides[0].Set(s_ptr->idx, 0, -1);
+    sides[1].Set(t_ptr->idx, 0, -1);
+    if (s_ptr->idx == t_ptr->idx) {
+        best = 0;
+        meet = s_ptr->idx;
+    }
+    else if (unweighted) {
+        // Expand whole levels of the smaller frontier; the best meeting found in the first level
+        // where the searches meet is optimal
+        sides[0].frontier.push_back(s_ptr->idx);
+        sides[1].frontier.push_back(t_ptr->idx);
+        while (meet == -1 && !sides[0].frontier.empty() && !sides[1].frontier.empty()) {
+            int dir = sides[0].frontier.size() <= sides[1].frontier.size() ? 0 : 1;
+            SearchSide &side = sides[dir], &other = sides[dir ^ 1];
+            side.next.clear();
+            for (int u : side.frontier) {
+                expand(dir, u);
+                for (auto e : neighbours) {
+                    int v = e.idx;
+                    if (!side.Seen(v)) {
+                        side.Set(v, side.dist[u] + 1, u);
+                        side.next.push_back(v);
+                    }
+                    if (other.Seen(v) && side.dist[v] + other.dist[v] < best) {
+                        best = side.dist[v] + other.dist[v];
+                        meet = v;
+                    }
+                }
+            }
+            side.frontier.swap(side.next);
+        }
+    }
+    else {
+        // Settle the side with the closer top; stop once the two tops cannot improve the best meeting
+        sides[0].heap.Push(0, s_ptr->idx);
+        sides[1].heap.Push(0, t_ptr->idx);
+        while (!sides[0].heap.Empty() && !sides[1].heap.Empty()) {
+            double top0 = sides[0].heap.Top().first, top1 = sides[1].heap.Top().first;
+            if (top0 + top1 >= best) break;
+            int dir = top0 <= top1 ? 0 : 1;
+            SearchSide &side = sides[dir], &other = sides[dir ^ 1];
+            auto [d, u] = side.heap.Pop();
+            if (d > side.dist[u]) continue;
+            expand(dir, u);
+            for (auto e : neighbours) {
+                int v = e.idx;
+                double nd = d + e.weight;
+                if (nd < side.Dist(v)) {
+                    side.Set(v, nd, u);
+                    side.heap.Push(nd, v);
+                }
+                if (other.Seen(v) && side.dist[v] + other.dist[v] < best) {
+                    best = side.dist[v] + other.dist[v];
+                    meet = v;
+                }
+            }
+        }
+    }
+    if (meet == -1) return 1e9;
+    if (path) {
+        for (int u = meet; u != -1; u = sides[0].parent[u]) path->push_back(vertex_index->vertex_table[u].node);
+        std::reverse(path->begin(), path->end());
+        for (int u = sides[1].parent[meet]; u != -1; u = sides[1].parent[u]) path->push_back(vertex_index->vertex_table[u].node);
+    }
+    return best;
+}
+
+RadixGraph::RadixGraph(int d, std::vector<int> _num_children, bool _enable_query, bool _enable_upsert, int _num_edge_types) {
     enable_query = _enable_query;
+    enable_upsert = _enable_upsert;
+    num_edge_types = std::min(std::max(_num_edge_types, 1), 256);
+    if (enable_upsert) {
+        vertex_lock = new AtomicBitmap(CAP_DUMMY_NODES);
+        vertex_lock->reset();
+    }
     if (enable_query) {
         degree = (std::atomic<int>*)calloc(CAP_DUMMY_NODES, sizeof(int));
-        bitmap = new AtomicBitmap*[max_number_of_threads];
-        for (int i = 0; i < max_number_of_threads; i++) bitmap[i] = new AtomicBitmap(CAP_DUMMY_NODES), bitmap[i]->reset();
     }
     vertex_index = new SORT(d, _num_children);
 }
 
 RadixGraph::~RadixGraph() {
-    if (bitmap) {
-        for (int i = 0; i < max_number_of_threads; i++) delete bitmap[i];
-        delete [] bitmap;
+    for (int i = 0; i < vertex_index->cnt; i++) {
+        auto& v = vertex_index->vertex_table[i];
+        if (v.frozen) delete v.frozen;
+        if (v.index) delete v.index;
+        TypedLog* logs = v.typed;
+        if (!logs) continue;
+        for (int t = 1; t < num_edge_types; t++) {
+            if (logs[t - 1].frozen) delete logs[t - 1].frozen;
+            if (logs[t - 1].index) delete logs[t - 1].index;
+        }
+        delete [] logs;
     }
+    if (vertex_lock) delete vertex_lock;
+    if (wcc) delete wcc;
     if (degree) free(degree);
     delete vertex_index;
 }
\ No newline at end of file
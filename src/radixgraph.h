@@ -16,64 +16,473 @@
 #ifndef RG
 #define RG
 
+#include <shared_mutex>
+
 #include "optimized_trie.h"
+#include "compressed_edges.h"
+
+/* DedupScratch:
+   - Scratch space used by GetNeighboursByOffset() to drop stale logs of an edge;
+   - Short logs are deduplicated with a small open-addressing set that stays cache-resident;
+   - Only hubs (logs longer than kHashLimit) fall back to a plain bitmap over vertex offsets,
+     which is allocated on first use and cleared word by word after each read;
+   - A DedupScratch must not be shared by concurrent reads. Reads without an explicit scratch use a
+     thread_local one, so they are safe under any threading runtime (OpenMP, std::thread, TBB, ...).
+*/
+class DedupScratch {
+    public:
+        static const int kHashLimit = 4096;
+
+        /*  Begin(): prepare the scratch space for deduplicating a log;
+            num_logs: the number of log entries to be scanned;
+            num_vertices: the number of vertex offsets a log entry may refer to. */
+        void Begin(int num_logs, int num_vertices) {
+            use_bitmap = num_logs > kHashLimit;
+            if (use_bitmap) {
+                size_t num_words = ((size_t)num_vertices + 63) / 64;
+                if (bits.size() < num_words) bits.resize(num_words, 0);
+            }
+            else {
+                size_t sz = 16;
+                while (sz < (size_t)num_logs * 2) sz <<= 1;
+                if (table.size() < sz) table.resize(sz, -1);
+                mask = sz - 1;
+            }
+        }
+
+        /*  TestAndSet(): mark an offset as seen; returns true if it has been seen before. */
+        bool TestAndSet(int idx) {
+            if (use_bitmap) {
+                uint64_t& word = bits[idx >> 6];
+                uint64_t bit = 1ull << (idx & 63);
+                if (word & bit) return true;
+                if (!word) dirty.push_back(idx >> 6);
+                word |= bit;
+                return false;
+            }
+            size_t pos = ((uint32_t)idx * 0x9E3779B1u) & mask;
+            while (table[pos] != -1) {
+                if (table[pos] == idx) return true;
+                pos = (pos + 1) & mask;
+            }
+            table[pos] = idx;
+            return false;
+        }
+
+        /*  Test(): check whether an offset has been seen, without marking it. */
+        bool Test(int idx) const {
+            if (use_bitmap) return (bits[idx >> 6] >> (idx & 63)) & 1;
+            size_t pos = ((uint32_t)idx * 0x9E3779B1u) & mask;
+            while (table[pos] != -1) {
+                if (table[pos] == idx) return true;
+                pos = (pos + 1) & mask;
+            }
+            return false;
+        }
+
+        /*  End(): clear the marks so that the scratch space can be reused. */
+        void End() {
+            if (use_bitmap) {
+                for (auto w : dirty) bits[w] = 0;
+                dirty.clear();
+            }
+            else {
+                std::fill(table.begin(), table.begin() + mask + 1, -1);
+            }
+        }
+
+    private:
+        bool use_bitmap = false;
+        size_t mask = 0;
+        std::vector<int> table, dirty;
+        std::vector<uint64_t> bits;
+};
+
+/* EdgeIndex:
+   - The live destination offsets of a vertex whose log is longer than kMinLog, built by the first
+     upsert-mode update that would otherwise scan such a log, and kept up to date by the later ones;
+     existence checks of upserts are then O(1) instead of a scan of the whole log;
+   - Open addressing with linear probing; erasing shifts the following entries back, so there are no tombstones;
+   - Only accessed under the vertex lock of its vertex.
+*/
+class EdgeIndex {
+    public:
+        static const int kMinLog = 32;
+
+        explicit EdgeIndex(const std::vector<WeightedEdge> &edges) {
+            Rehash(edges.size() * 2);
+            for (auto e : edges) Insert(e.idx);
+        }
+
+        bool Contains(int idx) const {
+            for (size_t i = Hash(idx); table[i] != -1; i = (i + 1) & mask) {
+                if (table[i] == idx) return true;
+            }
+            return false;
+        }
+
+        void Insert(int idx) {
+            if ((num + 1) * 2 > table.size()) Rehash(table.size() * 2);
+            size_t i = Hash(idx);
+            for (; table[i] != -1; i = (i + 1) & mask) {
+                if (table[i] == idx) return;
+            }
+            table[i] = idx;
+            num++;
+        }
+
+        void Erase(int idx) {
+            size_t i = Hash(idx);
+            for (; table[i] != idx; i = (i + 1) & mask) {
+                if (table[i] == -1) return;
+            }
+            // Move back every following entry of the cluster that may not stay behind the hole
+            for (size_t j = (i + 1) & mask; table[j] != -1; j = (j + 1) & mask) {
+                size_t home = Hash(table[j]);
+                if (((j - home) & mask) >= ((j - i) & mask)) {
+                    table[i] = table[j];
+                    i = j;
+                }
+            }
+            table[i] = -1;
+            num--;
+        }
+
+    private:
+        std::vector<int> table;
+        size_t num = 0, mask = 0;
+
+        size_t Hash(int idx) const {
+            return ((uint32_t)idx * 0x9E3779B1u) & mask;
+        }
+
+        void Rehash(size_t size) {
+            size_t sz = 16;
+            while (sz < size) sz <<= 1;
+            std::vector<int> old(sz, -1);
+            old.swap(table);
+            mask = sz - 1;
+            num = 0;
+            for (int idx : old) {
+                if (idx != -1) Insert(idx);
+            }
+        }
+};
+
+/* EdgeUpdate:
+   - An edge insertion or deletion, as applied in batches by incremental analytics;
+   - weight is ignored for deletions.
+*/
+typedef struct _edge_update {
+    NodeID src, des;
+    double weight = 1;
+    bool deleted = false;
+} EdgeUpdate;
+
+/* DistanceArray:
+   - The result of RadixGraph::SSSP(), owned by the caller and reused across searches;
+   - dist: the shortest distances by vertex offset (1e9 if unreachable);
+   - reached: the offsets with a distance below 1e9, so that the next search only resets those instead of
+     the whole array (reached_all marks that every entry has to be reset, e.g., after a parallel search);
+   - dist must not be modified between searches.
+*/
+typedef struct _distance_array {
+    std::vector<double> dist;
+    std::vector<int> reached;
+    bool reached_all = true;
+} DistanceArray;
+
+/* NeighbourCache:
+   - The deduplicated neighbour list of one vertex, owned by a sampling caller (e.g., a random walker);
+   - The samplers fill it when they have to materialize the list of src (its log has updates or
+     deletions) and then draw from it, so repeated draws at a vertex (rejection trials, revisits)
+     read the log once;
+   - It follows the graph only while the log of src is unchanged; set src to -1 after updating it.
+*/
+typedef struct _neighbour_cache {
+    int src = -1;
+    std::vector<WeightedEdge> neighbours;
+} NeighbourCache;
+
+/* EdgeFilter:
+   - A predicate on neighbour edges, evaluated by filtered neighbour reads while scanning the logs;
+   - min_weight, max_weight: the (inclusive) range of weights to keep;
+   - destinations: if not null, a bitset over vertex offsets (bit idx & 63 of word idx >> 6) of the
+     destinations to keep; it must cover every offset of the graph;
+   - type: the edge type to read; only the log of this type is scanned.
+*/
+typedef struct _edge_filter {
+    double min_weight = -std::numeric_limits<double>::infinity();
+    double max_weight = std::numeric_limits<double>::infinity();
+    const uint64_t* destinations = nullptr;
+    EdgeType type = 0;
+
+    bool Match(const WeightedEdge &e) const {
+        return e.weight >= min_weight && e.weight <= max_weight &&
+               (destinations == nullptr || ((destinations[e.idx >> 6] >> (e.idx & 63)) & 1));
+    }
+} EdgeFilter;
+
+/* ConcurrentUnionFind:
+   - A lock-free union-find over vertex offsets [0, size);
+   - parent[x] stores (parent of x) + 1, so that a zero-filled array means every vertex is its own root;
+   - parent[] is split into chunks of kChunkSize entries that are allocated on the first Union() touching
+     them (published with a CAS) and never move, so memory follows the offsets in use;
+   - Union() hooks the larger root under the smaller one with a CAS and retries on conflicts,
+     Find() compresses paths by halving; both are safe to call concurrently.
+*/
+class ConcurrentUnionFind {
+    public:
+        static const int kChunkBits = 16;
+        static const int kChunkSize = 1 << kChunkBits;
+
+        explicit ConcurrentUnionFind(size_t size) {
+            num_chunks = (size + kChunkSize - 1) >> kChunkBits;
+            chunks = new std::atomic<std::atomic<int>*>[num_chunks];
+            for (size_t i = 0; i < num_chunks; i++) chunks[i] = nullptr;
+        }
+        ~ConcurrentUnionFind() {
+            for (size_t i = 0; i < num_chunks; i++) free(chunks[i].load());
+            delete [] chunks;
+        }
+
+        // Make every offset in [0, size) its own root again; entries at or above size are left alone
+        void Reset(size_t size) {
+            size_t n = std::min((size + kChunkSize - 1) >> kChunkBits, num_chunks);
+            for (size_t i = 0; i < n; i++) {
+                std::atomic<int>* chunk = chunks[i];
+                if (!chunk) continue;
+                size_t end = std::min((size_t)kChunkSize, size - (i << kChunkBits));
+                for (size_t j = 0; j < end; j++) chunk[j].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        int Find(int x) {
+            while (true) {
+                int p = Parent(x);
+                if (!p) return x;
+                int gp = Parent(p - 1);
+                if (!gp) return p - 1;
+                // Path halving: point x to its grandparent
+                Slot(x).compare_exchange_weak(p, gp);
+                x = gp - 1;
+            }
+        }
+
+        void Union(int a, int b) {
+            while (true) {
+                a = Find(a), b = Find(b);
+                if (a == b) return;
+                if (a < b) std::swap(a, b);
+                int expected = 0;
+                if (Slot(a).compare_exchange_strong(expected, b + 1)) return;
+            }
+        }
+
+    private:
+        std::atomic<std::atomic<int>*>* chunks = nullptr;
+        size_t num_chunks = 0;
+
+        // parent[x], 0 if its chunk is not allocated yet
+        int Parent(int x) const {
+            std::atomic<int>* chunk = chunks[x >> kChunkBits];
+            return chunk ? chunk[x & (kChunkSize - 1)].load() : 0;
+        }
+
+        std::atomic<int>& Slot(int x) {
+            auto& c = chunks[x >> kChunkBits];
+            std::atomic<int>* chunk = c;
+            if (!chunk) {
+                auto fresh = (std::atomic<int>*)calloc(kChunkSize, sizeof(int));
+                if (c.compare_exchange_strong(chunk, fresh)) chunk = fresh;
+                else free(fresh);
+            }
+            return chunk[x & (kChunkSize - 1)];
+        }
+};
 
 class RadixGraph {
     private:
-        bool Insert(DummyNode* src, DummyNode* des, double weight);      
+        bool Insert(DummyNode* src, DummyNode* des, double weight, bool deleted=false);      
+        // The log of a non-default edge type of a vertex; allocates the typed logs of the vertex if create is set
+        TypedLog* GetTypedLog(DummyNode* v, EdgeType type, bool create);
+        // Rebuild the online WCC from the edge logs after deletions
+        void RebuildWCC();
+        // Link the components of two offsets in the online WCC, excluding rebuilds
+        void UnionWCC(int u, int v);
     public:
         SORT* vertex_index = nullptr;
-        bool enable_query = true;
+        bool enable_query = true, enable_upsert = false;
+        // Number of edge types, see EdgeType; analytics and untyped reads only see type 0
+        int num_edge_types = 1;
         std::atomic<int>* degree = nullptr;
-        AtomicBitmap** bitmap = nullptr;
+        // Per-vertex spin locks serializing the existence check and the append in upsert mode
+        AtomicBitmap* vertex_lock = nullptr;
+        // Online weakly connected components, see EnableOnlineWCC()
+        ConcurrentUnionFind* wcc = nullptr;
+        std::atomic<bool> wcc_stale = false;
+        // Held exclusively by rebuilds, and shared by queries and by the unions of insertions
+        std::shared_mutex wcc_mtx;
+        // Edges BFS() and SSSP() may scan sequentially before switching to the parallel kernels
+        long long scan_budget = 1 << 16;
  
         /* Sample edge and vertex;
            See detail structures in ``optimized_trie.h``.
         */
-        WeightedEdge sample_edge = {/* weight */0.5, /* offset */2};
+        WeightedEdge sample_edge = MakeEdge(/* offset */2, /* weight */0.5);
         DummyNode sample_vertex = {/* ID */10, /* Offset */0, /* Del_time */0, /* EdgeArr */tbb::concurrent_vector<WeightedEdge>(), /* Degree */0};
 
         /*  InsertEdge(): insert an edge to RadixGraph;
             src: the source vertex of the edge;
             des: the destination vertex of the edge;
-            weight: the weight of the edge. */
+            weight: the weight of the edge.
+            In upsert mode, inserting an existing edge is turned into an update and false is returned. */
         bool InsertEdge(NodeID src, NodeID des, double weight);
         /*  UpdateEdge(): update an edge to RadixGraph;
             src: the source vertex of the edge;
             des: the destination vertex of the edge;
-            weight: the updated weight of the edge. */
+            weight: the updated weight of the edge.
+            In upsert mode, returns false if the edge does not exist. */
         bool UpdateEdge(NodeID src, NodeID des, double weight);
         /*  DeleteEdge(): delete an edge from RadixGraph;
             src: the source vertex of the edge;
-            des: the destination vertex of the edge. */
+            des: the destination vertex of the edge.
+            In upsert mode, returns false if the edge does not exist. */
         bool DeleteEdge(NodeID src, NodeID des);
+        /*  HasEdge(): check whether an edge is currently in RadixGraph;
+            src: the source vertex of the edge;
+            des: the destination vertex of the edge. */
+        bool HasEdge(NodeID src, NodeID des);
+        /*  HasEdgeByOffset(): check whether an edge is currently in RadixGraph given vertex offsets;
+            the latest log of (src, des) is searched backwards, so recently touched edges are found quickly;
+            src: the offset of the source vertex;
+            des: the offset of the destination vertex. */
+        bool HasEdgeByOffset(int src, int des);
+        /*  InsertUndirectedEdge(): insert or update both directions of an undirected edge;
+            returns true if (u, v) was not in RadixGraph before. */
+        bool InsertUndirectedEdge(NodeID u, NodeID v, double weight);
+        /*  DeleteUndirectedEdge(): delete both directions of an undirected edge;
+            returns false if (u, v) is not in RadixGraph. */
+        bool DeleteUndirectedEdge(NodeID u, NodeID v);
+        /*  InsertEdge(), UpdateEdge(), DeleteEdge(), HasEdge(), HasEdgeByOffset(): same as above, for the edges of a type;
+            edges of different types between the same vertices are independent; typed edges other than type 0
+            are not counted by degree[] and not tracked by the online WCC;
+            type: the edge type, less than num_edge_types; operations on other types return false. */
+        bool InsertEdge(NodeID src, NodeID des, double weight, EdgeType type);
+        bool UpdateEdge(NodeID src, NodeID des, double weight, EdgeType type);
+        bool DeleteEdge(NodeID src, NodeID des, EdgeType type);
+        bool HasEdge(NodeID src, NodeID des, EdgeType type);
+        bool HasEdgeByOffset(int src, int des, EdgeType type);
         /*  GetNeighbours(): get neighbours given a vertex ID;
             src: the target vertex ID;
             neighbours: neighbour edges of src are stored in this array;
-            timestamp: the version (size) of the edge array, -1 means retrieving the latest version. */
+            timestamp: the version (size) of the edge array, -1 means retrieving the latest version;
+                       versions are counted from the last Compact(). */
         bool GetNeighbours(NodeID src, std::vector<WeightedEdge> &neighbours, int timestamp=-1);
         /*  GetNeighboursByOffset(): get neighbours given a vertex dummy node;
             src: the offset of the source vertex, i.e., the logical ID of the vertex;
             neighbours: neighbour edges of src are stored in this array;
-            timestamp: the version (size) of the edge array, -1 means retrieving the latest version. */
+            timestamp: the version (size) of the edge array, -1 means retrieving the latest version;
+                       versions are counted from the last Compact(). */
         bool GetNeighboursByOffset(int src, std::vector<WeightedEdge> &neighbours, int timestamp=-1);
+        /*  GetNeighboursByOffset(): same as above, but deduplicates logs with a caller-owned scratch space;
+            scratch: the scratch space, e.g., one per task of a work-stealing executor. */
+        bool GetNeighboursByOffset(int src, std::vector<WeightedEdge> &neighbours, DedupScratch &scratch, int timestamp=-1);
+        /*  GetNeighbours(): get the neighbour edges of a vertex ID that match a filter;
+            the filter is applied while scanning, so only matching edges are copied; only the log of
+            filter.type is read, so typed traversals skip the edges of other types. */
+        bool GetNeighbours(NodeID src, std::vector<WeightedEdge> &neighbours, const EdgeFilter &filter, int timestamp=-1);
+        /*  GetNeighboursByOffset(): get the neighbour edges of a vertex offset that match a filter;
+            compacted edges are first tested by weight a block at a time, and blocks without matches
+            are not decoded. */
+        bool GetNeighboursByOffset(int src, std::vector<WeightedEdge> &neighbours, const EdgeFilter &filter, int timestamp=-1);
+        /*  GetNeighbourByOffset(): get the k-th neighbour edge of a vertex, in the order of GetNeighboursByOffset();
+            logs without updates or deletions are indexed directly, other logs are materialized first;
+            src: the offset of the source vertex;
+            k: the rank of the neighbour;
+            e: the neighbour edge is stored here;
+            cache: if not null, materialized lists are kept there and reused while it holds src;
+            Returns false if src has at most k neighbours. */
+        bool GetNeighbourByOffset(int src, int k, WeightedEdge &e, NeighbourCache *cache=nullptr);
+        /*  GetRandomNeighbour(): sample a neighbour edge of a vertex ID;
+            rng: the random engine of the calling thread;
+            e: the sampled edge is stored here;
+            weighted: sample with probability proportional to edge weights instead of uniformly;
+            Returns false if the vertex does not exist or has no neighbours. */
+        bool GetRandomNeighbour(NodeID src, std::mt19937_64 &rng, WeightedEdge &e, bool weighted=false);
+        /*  GetRandomNeighbourByOffset(): sample a neighbour edge uniformly, given the offset of the vertex;
+            draws a rank and reads it with GetNeighbourByOffset(), so no list is materialized when the log
+            has no updates or deletions; cache: as in GetNeighbourByOffset(). */
+        bool GetRandomNeighbourByOffset(int src, std::mt19937_64 &rng, WeightedEdge &e, NeighbourCache *cache=nullptr);
+        /*  GetWeightedRandomNeighbourByOffset(): sample a neighbour edge with probability proportional to its weight,
+            by rejection against an upper bound of the weights;
+            max_weight: the bound, e.g., cached from MaxWeightByOffset(); computed when not positive;
+            cache: as in GetNeighbourByOffset(). */
+        bool GetWeightedRandomNeighbourByOffset(int src, std::mt19937_64 &rng, WeightedEdge &e, double max_weight=0,
+                                                NeighbourCache *cache=nullptr);
+        /*  MaxWeightByOffset(): an upper bound of the weights of the edges of a vertex
+            (the maximum over its compacted block and its log, including stale log entries). */
+        double MaxWeightByOffset(int src);
+
+        /*  EnableOnlineWCC(): track weakly connected components on ingest;
+            InsertEdge() then links the components of both endpoints in O(α) time, while DeleteEdge() only marks
+            the components stale and the next query rebuilds them in one pass over the edge logs;
+            queries and the links of insertions wait for a rebuild in progress; queries that trigger a
+            rebuild must not run concurrently with deletions. */
+        void EnableOnlineWCC();
+        /*  GetComponent(): get the component of a vertex ID, represented by the smallest offset in it
+            (-1 if the vertex does not exist or online WCC is not enabled). */
+        int GetComponent(NodeID v);
+        /*  GetComponentByOffset(): same as above, given the offset of the vertex. */
+        int GetComponentByOffset(int v);
+        /*  Connected(): whether two vertex IDs are in the same weakly connected component. */
+        bool Connected(NodeID u, NodeID v);
+
+        /*  Compact(): freeze the live edges of every vertex into a compressed, read-optimized encoding
+            (see ``compressed_edges.h``) and truncate the edge logs;
+            must not run concurrently with updates or reads;
+            quantize_weights: whether to truncate non-uniform weights to 16 bits. */
+        void Compact(bool quantize_weights=false);
 
-        /*  BFS(): get all reachable vertices from a given vertex ID (single-threaded);
+        /*  BFS(): get all reachable vertices from a given vertex ID;
+            Starts sequentially with reusable per-thread state, and restarts with the parallel DOBFS
+            once more than scan_budget edges have been scanned (requires enable_query);
             src: the source vertex ID;
-            Returns an array of all reachable vertex IDs.
+            directed: whether the graph may be non-symmetric; the parallel search only goes bottom-up
+                      (which follows edges backwards) on symmetric graphs;
+            Returns an array of all reachable vertex IDs (in no particular order).
         */
-        std::vector<uint64_t> BFS(NodeID src);
-        /*  SSSP(): get shortest distances from a given vertex ID (single-threaded);
+        std::vector<uint64_t> BFS(NodeID src, bool directed=true);
+        /*  SSSP(): get shortest distances from a given vertex ID;
+            Starts with a sequential Dijkstra on a radix heap, and restarts with the parallel DeltaStep
+            once more than scan_budget edges have been scanned;
             src: the source vertex ID;
-            Returns an array of numbers containing shortest distances to all vertices.
+            Returns an array of numbers containing shortest distances to all vertices (by offset, 1e9 if unreachable).
         */
         std::vector<double> SSSP(NodeID src);
+        /*  SSSP(): same as above, but writes the distances to a caller-owned DistanceArray; a sequential
+            search only resets the entries the previous search into it reached, so small searches
+            cost time proportional to what they visit rather than to the number of vertices;
+        */
+        void SSSP(NodeID src, DistanceArray &res);
+        /*  ShortestPath(): get the shortest distance between two vertex IDs with a bidirectional search,
+            which stops as soon as the forward and backward searches meet;
+            s, t: the source and target vertex IDs;
+            path: if not null, receives the vertex IDs of a shortest path from s to t (empty if unreachable);
+            reverse: a RadixGraph holding every edge reversed (offsets may differ); nullptr if this graph is symmetric;
+            unweighted: use bidirectional BFS (hop counts) instead of bidirectional Dijkstra; implied by RG_WEIGHT_NONE;
+            Returns the distance from s to t, 1e9 if unreachable.
+        */
+        double ShortestPath(NodeID s, NodeID t, std::vector<uint64_t>* path=nullptr, RadixGraph* reverse=nullptr, bool unweighted=false);
 
         /*  RadixGraph(): initialization of a RadixGraph instance;
             d: depth of the SORT (vertex index);
             _num_children: a_i for each layer i, meaning a node in the i-th layer has 2^(a_i) child pointers;
-            enable_query: whether to enable querying components (bitmaps). */ 
-        RadixGraph(int d, std::vector<int> _num_children, bool _enable_query=true);
+            enable_query: whether to enable querying components (bitmaps);
+            enable_upsert: whether to check edge existence on updates so that duplicate inserts do not
+                           increase degrees and updates/deletes of absent edges are rejected;
+            num_edge_types: the number of edge types (at most 256), sharing one vertex index. */ 
+        RadixGraph(int d, std::vector<int> _num_children, bool _enable_query=true, bool _enable_upsert=false, int _num_edge_types=1);
         ~RadixGraph();
 };
 
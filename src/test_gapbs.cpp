@@ -19,7 +19,17 @@
 #include "./GAPBS/sssp.h"
 #include "./GAPBS/tc.h"
 #include "./GAPBS/cc_sv.h"
+#include "./GAPBS/cc_afforest.h"
 #include "./GAPBS/pr_spmv.h"
+#include "./GAPBS/ppr.h"
+#include "./GAPBS/bc.h"
+#include "./GAPBS/msbfs.h"
+#include "./GAPBS/distance_oracle.h"
+#include "./GAPBS/dynamic_sssp.h"
+#include "./GAPBS/kcore.h"
+#include "./GAPBS/lpa.h"
+#include "./GAPBS/random_walk.h"
+#include "./GAPBS/ligra.h"
 
 int main(int argc, char* argv[]) {
     std::ios::sync_with_stdio(false);
@@ -84,7 +94,6 @@ int main(int argc, char* argv[]) {
     int d = 3;
     std::vector<int> a = {7, 7, 6};
     int n = 100000, m = 10000000;
-    int num_trials = 3;
     
     std::default_random_engine generator;
     unsigned long long maximum = (1ull << 20) - 1;
@@ -102,16 +111,14 @@ int main(int argc, char* argv[]) {
     }
 
     std::vector<std::pair<std::pair<uint64_t, uint64_t>, double>> edges;
-    uint64_t u, v;
-    double w;
     // for (int i = 0; i < n - 1; i++) {
     //     edges.push_back(std::make_pair(std::make_pair(vertex_ids[i], vertex_ids[i + 1]), 0.5));
     // }
     std::set<std::pair<uint64_t, uint64_t>> edge_set;
     for (int i = 0; i < m; i++) {
         int id1 = rand() % n, id2 = rand() % n;
-        u = vertex_ids[id1];
-        v = vertex_ids[id2];
+        uint64_t u = vertex_ids[id1];
+        uint64_t v = vertex_ids[id2];
         while (edge_set.find({u, v}) != edge_set.end()) {
             id1 = rand() % n, id2 = rand() % n;
             u = vertex_ids[id1];
@@ -127,13 +134,22 @@ int main(int argc, char* argv[]) {
         G.InsertEdge(e.first.first, e.first.second, e.second);
     }
 
+    // The undirected graphs of the kernels below: the first num_edges edges, inserted in both directions
+    auto insert_symmetric = [&](RadixGraph &g, int num_edges) {
+        for (int i = 0; i < num_edges; i++) {
+            auto e = edges[i].first;
+            g.InsertEdge(e.first, e.second, 0.5);
+            g.InsertEdge(e.second, e.first, 0.5);
+        }
+    };
+
     // Test BFS
     std::cout << "Testing BFS..." << std::endl;
     auto res1 = G.BFS(vertex_ids[0]);
     auto p = DOBFS(&G, vertex_ids[0], n, m, -1);
     std::vector<uint64_t> res2;
     for (int i = 0; i < n; i++) {
-        if (p[i] != -1) {
+        if (p[i] != (NodeID)-1) {
             res2.emplace_back(G.vertex_index->vertex_table[i].node);
         }
     }
@@ -143,24 +159,53 @@ int main(int argc, char* argv[]) {
         std::cout << "BFS wrong results detected. Expected size = " << res1.size() << ", actual size = " << res2.size() << std::endl;
         return 0;
     }
-    for (int i = 0; i < res1.size(); i++) {
+    for (size_t i = 0; i < res1.size(); i++) {
         if (res1[i] != res2[i]) {
             std::cout << "BFS wrong results detected. Wrong node id." << std::endl;
             return 0;
         }
     }
+    // The sequential path (never switching to DOBFS) must agree as well, and so must a
+    // search handed over to DOBFS after only a few vertices
+    G.scan_budget = LLONG_MAX;
+    auto res0 = G.BFS(vertex_ids[0]);
+    std::sort(res0.begin(), res0.end());
+    G.scan_budget = 1 << 4;
+    auto res6 = G.BFS(vertex_ids[0]);
+    std::sort(res6.begin(), res6.end());
+    G.scan_budget = 1 << 16;
+    if (res0 != res1 || res6 != res1) {
+        std::cout << "BFS wrong results detected. Sequential and parallel searches differ." << std::endl;
+        return 0;
+    }
     std::cout << "BFS results verified!" << std::endl;
 
     // Test SSSP
     std::cout << "Testing SSSP..." << std::endl;
     auto res3 = G.SSSP(vertex_ids[0]);
+    // Searches reusing one distance array; the third one goes parallel and writes the whole array
+    DistanceArray reused;
+    for (int i = 0; i < 6; i++) {
+        if (i == 2) G.scan_budget = 1 << 4;
+        G.SSSP(vertex_ids[i], reused);
+        G.scan_budget = LLONG_MAX;
+        auto expected = G.SSSP(vertex_ids[i]);
+        for (int j = 0; j < n; j++) {
+            if (abs(reused.dist[j] - expected[j]) > 1e-6) {
+                std::cout << "SSSP wrong results detected. Searches into a reused array differ." << std::endl;
+                return 0;
+            }
+        }
+    }
+    G.scan_budget = 1 << 16;
+    auto res5 = G.SSSP(vertex_ids[0]);
     auto res4 = DeltaStep(&G, vertex_ids[0], 2.0, n, m);
-    if (res3.size() != res4.size()) {
+    if (res3.size() != res4.size() || res3.size() != res5.size()) {
         std::cout << "SSSP wrong results detected. Expected size = " << res3.size() << ", actual size = " << res4.size() << std::endl;
         return 0;
     }
-    for (int i = 0; i < res3.size(); i++) {
-        if ((res3[i] <= 1e9 || res4[i] <= 1e9) && abs(res3[i] - res4[i]) > 1e-6) {
+    for (size_t i = 0; i < res3.size(); i++) {
+        if ((res3[i] <= 1e9 || res4[i] <= 1e9) && (abs(res3[i] - res4[i]) > 1e-6 || abs(res3[i] - res5[i]) > 1e-6)) {
             std::cout << "SSSP wrong results detected. Distance of node " << G.vertex_index->vertex_table[i].node << " is expected to be: " << res3[i] << ", actual: " << res4[i] << std::endl;
             return 0;
         }
@@ -170,14 +215,996 @@ int main(int argc, char* argv[]) {
     // Test LCC
     std::cout << "Testing LCC..." << std::endl;
     OrderedCount(&G, n);
+    {
+        // A clique of 99 vertices, a hub adjacent to all of them, and vertices attached to two clique
+        // vertices each: the latter intersect a one-element prefix with a long list (galloping), while
+        // clique lists of sizes that are no multiples of 4 go through the SIMD blocks and their tails
+        RadixGraph T(d, a, true, true);
+        auto link = [&](uint64_t x, uint64_t y) {
+            T.InsertEdge(x, y, 0.5);
+            T.InsertEdge(y, x, 0.5);
+        };
+        for (int i = 0; i < 99; i++) {
+            for (int j = i + 1; j < 99; j++) link(vertex_ids[i], vertex_ids[j]);
+            link(vertex_ids[i], vertex_ids[300]);
+        }
+        for (int i = 100; i < 300; i++) {
+            link(vertex_ids[i], vertex_ids[rand() % 99]);
+            link(vertex_ids[i], vertex_ids[rand() % 99]);
+            link(vertex_ids[i], vertex_ids[300]);
+        }
+        for (int i = 0; i < 20000; i++) link(edges[i].first.first, edges[i].first.second);
+        int num_nodes = T.vertex_index->cnt;
+        std::vector<std::set<int>> adj(num_nodes);
+        for (int i = 0; i < num_nodes; i++) {
+            std::vector<WeightedEdge> neighbours;
+            T.GetNeighboursByOffset(i, neighbours);
+            for (auto e : neighbours) {
+                if (e.idx != i) adj[i].insert(e.idx);
+            }
+        }
+        auto triangles = TrianglesPerVertex(&T, num_nodes);
+        auto lcc = OrderedCount(&T, num_nodes);
+        for (int i = 0; i < num_nodes; i++) {
+            uint32_t expected = 0;
+            for (int x : adj[i]) {
+                for (int y : adj[i]) {
+                    if (x < y && adj[x].count(y)) expected++;
+                }
+            }
+            uint64_t degree = T.vertex_index->vertex_table[i].deg;
+            double expected_lcc = degree > 1 ? 2.0 * expected / (degree * (degree - 1)) : 0.0;
+            if (triangles[i] != expected || std::abs(lcc[i] - expected_lcc) > 1e-9) {
+                std::cout << "LCC wrong results detected. Triangles of node " << T.vertex_index->vertex_table[i].node << " is expected to be: " << expected << ", actual: " << triangles[i] << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "LCC results verified!" << std::endl;
+
+    // Test dynamic LCC
+    std::cout << "Testing dynamic LCC..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        insert_symmetric(U, 20000);
+        DynamicTriangleCount tc(&U, U.vertex_index->cnt);
+        std::vector<EdgeUpdate> batch;
+        for (int i = 20000; i < 25000; i++) batch.push_back({(NodeID)edges[i].first.first, (NodeID)edges[i].first.second, 0.5, false});
+        for (int i = 0; i < 2000; i++) batch.push_back({(NodeID)edges[i * 10].first.first, (NodeID)edges[i * 10].first.second, 0.5, true});
+        tc.ApplyBatch(batch);
+        auto expected = TrianglesPerVertex(&U, U.vertex_index->cnt);
+        for (int i = 0; i < U.vertex_index->cnt; i++) {
+            if (expected[i] != tc.triangles_per_vertex[i]) {
+                std::cout << "Dynamic LCC wrong results detected. Triangles of node " << U.vertex_index->vertex_table[i].node << " is expected to be: " << expected[i] << ", actual: " << tc.triangles_per_vertex[i] << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "Dynamic LCC results verified!" << std::endl;
 
     // Test WCC
     std::cout << "Testing WCC..." << std::endl;
-    ShiloachVishkin(&G, n);
+    auto comp = ShiloachVishkin(&G, n);
+    auto comp_afforest = Afforest(&G, n, true);
+    for (int i = 0; i < n; i++) {
+        if (comp[i] != comp_afforest[i]) {
+            std::cout << "Afforest wrong results detected. Component of node " << G.vertex_index->vertex_table[i].node << " is expected to be: " << comp[i] << ", actual: " << comp_afforest[i] << std::endl;
+            return 0;
+        }
+    }
+    {
+        // On a symmetric graph the final pass skips the sampled giant component
+        RadixGraph S(d, a, true);
+        insert_symmetric(S, 20000);
+        int num_nodes = S.vertex_index->cnt;
+        auto comp_sv = ShiloachVishkin(&S, num_nodes);
+        auto comp_sym = Afforest(&S, num_nodes);
+        for (int i = 0; i < num_nodes; i++) {
+            if (comp_sv[i] != comp_sym[i]) {
+                std::cout << "Afforest wrong results detected on a symmetric graph. Component of node " << S.vertex_index->vertex_table[i].node << " is expected to be: " << comp_sv[i] << ", actual: " << comp_sym[i] << std::endl;
+                return 0;
+            }
+        }
+    }
+    G.EnableOnlineWCC();
+    for (int i = 0; i < n; i++) {
+        if (comp[i] != (NodeID)G.GetComponentByOffset(i)) {
+            std::cout << "WCC wrong results detected. Component of node " << G.vertex_index->vertex_table[i].node << " is expected to be: " << comp[i] << ", actual: " << G.GetComponentByOffset(i) << std::endl;
+            return 0;
+        }
+    }
+    {
+        // Rebuilds triggered by queries race with insertions, many of them creating vertices
+        RadixGraph W(d, a, true, true);
+        W.EnableOnlineWCC();
+        for (int i = 0; i < 20000; i++) W.InsertEdge(edges[i].first.first, edges[i].first.second, 0.5);
+        std::thread writer([&]() {
+            for (int i = 20000; i < 60000; i++) W.InsertEdge(edges[i].first.first, edges[i].first.second, 0.5);
+        });
+        for (int k = 0; k < 200; k++) {
+            W.DeleteEdge(edges[k].first.first, edges[k].first.second);
+            W.GetComponentByOffset(0);
+        }
+        writer.join();
+        int num_nodes = W.vertex_index->cnt;
+        auto expected = ShiloachVishkin(&W, num_nodes);
+        for (int i = 0; i < num_nodes; i++) {
+            if (expected[i] != (NodeID)W.GetComponentByOffset(i)) {
+                std::cout << "WCC wrong results detected. Component of node " << W.vertex_index->vertex_table[i].node << " after concurrent rebuilds is expected to be: " << expected[i] << ", actual: " << W.GetComponentByOffset(i) << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "WCC results verified!" << std::endl;
 
     // Test PageRank
     std::cout << "Testing PageRank..." << std::endl;
     PageRankPull(&G, 100, n);
 
+    // Test dynamic PageRank
+    std::cout << "Testing dynamic PageRank..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        insert_symmetric(U, 20000);
+        int num_nodes = U.vertex_index->cnt;
+        DynamicPageRank pr(&U, num_nodes, 1000, 1e-12);
+        for (int i = 0; i < 100; i++) {
+            auto e = edges[i * 7].first;
+            bool inserted = i % 2 ? U.InsertEdge(e.first, e.second, 0.5) : U.DeleteEdge(e.first, e.second);
+            if (!inserted) continue;
+            if (i % 2) U.InsertEdge(e.second, e.first, 0.5);
+            else U.DeleteEdge(e.second, e.first);
+            pr.Touch(e.first);
+            pr.Touch(e.second);
+        }
+        if (pr.Refresh(1e-12) >= 1000) {
+            std::cout << "Dynamic PageRank wrong results detected. Residuals did not converge." << std::endl;
+            return 0;
+        }
+        auto expected = PageRankPull(&U, 1000, num_nodes, 1e-9);
+        for (int i = 0; i < num_nodes; i++) {
+            if (abs(expected[i] - pr.scores[i]) > 1e-5 * expected[i]) {
+                std::cout << "Dynamic PageRank wrong results detected. Score of node " << U.vertex_index->vertex_table[i].node << " is expected to be: " << expected[i] << ", actual: " << pr.scores[i] << std::endl;
+                return 0;
+            }
+        }
+        // Isolate a few vertices under an epsilon loose enough that their
+        // dangling toggles are folded into the pending uniform residual
+        std::vector<WeightedEdge> neighbours;
+        for (int i = 0; i < 20; i++) {
+            NodeID x = U.vertex_index->vertex_table[i * 97].node;
+            U.GetNeighbours(x, neighbours);
+            for (auto e : neighbours) {
+                NodeID y = U.vertex_index->vertex_table[e.idx].node;
+                U.DeleteEdge(x, y);
+                U.DeleteEdge(y, x);
+                pr.Touch(y);
+            }
+            pr.Touch(x);
+        }
+        pr.Refresh(1e-8);
+        expected = PageRankPull(&U, 1000, num_nodes, 1e-9);
+        for (int i = 0; i < num_nodes; i++) {
+            if (abs(expected[i] - pr.scores[i]) > 5e-3 * expected[i]) {
+                std::cout << "Dynamic PageRank wrong results detected. Score of node " << U.vertex_index->vertex_table[i].node << " after isolating vertices is expected to be: " << expected[i] << ", actual: " << pr.scores[i] << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "Dynamic PageRank results verified!" << std::endl;
+
+    // Test Gauss-Seidel and delta PageRank
+    std::cout << "Testing PageRank variants..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        insert_symmetric(U, 20000);
+        int num_nodes = U.vertex_index->cnt;
+        auto expected = PageRankPull(&U, 1000, num_nodes, 1e-9);
+        int gs_iters = 0, delta_iters = 0;
+        auto gs = PageRankPullGS(&U, 1000, num_nodes, 1e-9, &gs_iters);
+        auto delta = PageRankDelta(&U, 1000, num_nodes, 1e-9, &delta_iters);
+        if (gs_iters >= 1000 || delta_iters >= 1000) {
+            std::cout << "PageRank variants wrong results detected. Not converged within 1000 iterations." << std::endl;
+            return 0;
+        }
+        for (int i = 0; i < num_nodes; i++) {
+            if (abs(expected[i] - gs[i]) > 1e-4 * expected[i] || abs(expected[i] - delta[i]) > 1e-4 * expected[i]) {
+                std::cout << "PageRank variants wrong results detected. Score of node " << U.vertex_index->vertex_table[i].node << " is expected to be: " << expected[i] << ", actual: " << gs[i] << " (Gauss-Seidel), " << delta[i] << " (delta)" << std::endl;
+                return 0;
+            }
+        }
+        // Under a loose epsilon the skipped changes stay in residuals, so the total drift stays below it
+        auto loose = PageRankDelta(&U, 1000, num_nodes, 1e-4);
+        double drift = 0;
+        for (int i = 0; i < num_nodes; i++) drift += fabs(loose[i] - expected[i]);
+        if (drift > 1e-4) {
+            std::cout << "PageRank variants wrong results detected. Delta PageRank drifted by " << drift << " under epsilon 1e-4." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "PageRank variants results verified!" << std::endl;
+
+    // Test personalized PageRank
+    std::cout << "Testing personalized PageRank..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        int num_edges = 0;
+        for (int i = 0; i < 20000; i++) {
+            auto e = edges[i].first;
+            num_edges += U.InsertEdge(e.first, e.second, 0.5);
+        }
+        int num_nodes = U.vertex_index->cnt;
+        std::vector<NodeID> sources;
+        for (int i = 0; i < 8; i++) sources.push_back(edges[i * 13].first.first);
+        double alpha = 0.15, epsilon = 1e-7;
+        auto batch = PersonalizedPageRankBatch(&U, sources, alpha, epsilon);
+        for (size_t i = 0; i < sources.size(); i++) {
+            // Power iteration over out-edges, with dangling vertices jumping back to the source
+            int s = U.vertex_index->RetrieveVertex(sources[i])->idx;
+            std::vector<double> x(num_nodes, 0), y(num_nodes);
+            x[s] = 1;
+            for (int iter = 0; iter < 200; iter++) {
+                std::fill(y.begin(), y.end(), 0);
+                y[s] = alpha;
+                for (int v = 0; v < num_nodes; v++) {
+                    if (x[v] == 0) continue;
+                    std::vector<WeightedEdge> neighbours;
+                    U.GetNeighboursByOffset(v, neighbours);
+                    if (neighbours.empty()) y[s] += (1 - alpha) * x[v];
+                    for (auto e : neighbours) y[e.idx] += (1 - alpha) * x[v] / neighbours.size();
+                }
+                x.swap(y);
+            }
+            auto single = PersonalizedPageRank(&U, sources[i], alpha, epsilon);
+            std::vector<double> estimate(num_nodes, 0);
+            for (auto p : single) estimate[p.first] = p.second;
+            double l1 = 0;
+            for (int v = 0; v < num_nodes; v++) l1 += abs(x[v] - estimate[v]);
+            if (l1 > epsilon * num_edges + 1e-5 || single != batch[i]) {
+                std::cout << "Personalized PageRank wrong results detected. L1 error from node " << sources[i] << " is " << l1 << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "Personalized PageRank results verified!" << std::endl;
+
+    // Test betweenness centrality
+    std::cout << "Testing BC..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        insert_symmetric(U, 20000);
+        int num_nodes = U.vertex_index->cnt;
+        std::vector<int> sources;
+        for (int i = 0; i < 16; i++) sources.push_back(U.vertex_index->RetrieveVertex(edges[i * 31].first.first)->idx);
+        auto scores = Brandes(&U, num_nodes, sources);
+        // Sequential Brandes from the same sources
+        std::vector<double> expected(num_nodes, 0);
+        for (int s : sources) {
+            std::vector<int> depth(num_nodes, -1), order;
+            std::vector<double> sigma(num_nodes, 0), delta(num_nodes, 0);
+            depth[s] = 0, sigma[s] = 1;
+            order.push_back(s);
+            for (size_t i = 0; i < order.size(); i++) {
+                int u = order[i];
+                std::vector<WeightedEdge> neighbours;
+                U.GetNeighboursByOffset(u, neighbours);
+                for (auto e : neighbours) {
+                    if (depth[e.idx] == -1) depth[e.idx] = depth[u] + 1, order.push_back(e.idx);
+                    if (depth[e.idx] == depth[u] + 1) sigma[e.idx] += sigma[u];
+                }
+            }
+            for (int i = order.size() - 1; i >= 0; i--) {
+                int u = order[i];
+                std::vector<WeightedEdge> neighbours;
+                U.GetNeighboursByOffset(u, neighbours);
+                for (auto e : neighbours) {
+                    if (depth[e.idx] == depth[u] + 1) delta[u] += sigma[u] / sigma[e.idx] * (1 + delta[e.idx]);
+                }
+                expected[u] += delta[u];
+            }
+        }
+        double biggest = *std::max_element(expected.begin(), expected.end());
+        for (int i = 0; i < num_nodes; i++) {
+            if (abs(expected[i] / biggest - scores[i]) > 1e-4) {
+                std::cout << "BC wrong results detected. Score of node " << U.vertex_index->vertex_table[i].node << " is expected to be: " << expected[i] / biggest << ", actual: " << scores[i] << std::endl;
+                return 0;
+            }
+        }
+        Brandes(&U, num_nodes, 16);
+        // An empty graph has no source to sample
+        RadixGraph E(d, a);
+        if (Brandes(&E, 0, 16).size() != 0) {
+            std::cout << "BC wrong results detected. Scores of an empty graph are not empty." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "BC results verified!" << std::endl;
+
+    // Test multi-source BFS
+    std::cout << "Testing MS-BFS..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        for (int i = 0; i < 40000; i++) {
+            auto e = edges[i].first;
+            U.InsertEdge(e.first, e.second, 0.5);
+        }
+        int num_nodes = U.vertex_index->cnt;
+        std::vector<NodeID> sources;
+        for (int i = 0; i < 300; i++) sources.push_back(edges[i * 17].first.first);
+        auto dist = MultiSourceBFS(&U, sources, num_nodes);
+        for (size_t i = 0; i < sources.size(); i++) {
+            std::vector<int> expected(num_nodes, -1);
+            std::queue<int> Q;
+            int s = U.vertex_index->RetrieveVertex(sources[i])->idx;
+            expected[s] = 0;
+            Q.push(s);
+            while (!Q.empty()) {
+                int u = Q.front();
+                Q.pop();
+                std::vector<WeightedEdge> neighbours;
+                U.GetNeighboursByOffset(u, neighbours);
+                for (auto e : neighbours) {
+                    if (expected[e.idx] == -1) expected[e.idx] = expected[u] + 1, Q.push(e.idx);
+                }
+            }
+            for (int v = 0; v < num_nodes; v++) {
+                if (expected[v] != dist[i][v]) {
+                    std::cout << "MS-BFS wrong results detected. Distance from node " << sources[i] << " to node " << U.vertex_index->vertex_table[v].node << " is expected to be: " << expected[v] << ", actual: " << dist[i][v] << std::endl;
+                    return 0;
+                }
+            }
+        }
+    }
+    std::cout << "MS-BFS results verified!" << std::endl;
+
+    // Test point-to-point shortest paths
+    std::cout << "Testing shortest paths..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true), R(d, a, true, true);
+        for (int i = 0; i < 40000; i++) {
+            auto e = edges[i];
+            U.InsertEdge(e.first.first, e.first.second, e.second);
+            R.InsertEdge(e.first.second, e.first.first, e.second);
+        }
+        std::vector<NodeID> sources;
+        for (int i = 0; i < 20; i++) sources.push_back(edges[i * 37].first.first);
+        auto hops = MultiSourceBFS(&U, sources, U.vertex_index->cnt);
+        for (size_t i = 0; i < sources.size(); i++) {
+            auto dist = U.SSSP(sources[i]);
+            for (int j = 0; j < 50; j++) {
+                NodeID t = edges[j * 101 + i].first.second;
+                int tidx = U.vertex_index->RetrieveVertex(t)->idx;
+                std::vector<uint64_t> path;
+                double res = U.ShortestPath(sources[i], t, &path, &R);
+                double hop = U.ShortestPath(sources[i], t, nullptr, &R, true);
+                double expected_hop = hops[i][tidx] == -1 ? 1e9 : hops[i][tidx];
+                // The path must start at s, end at t, and consist of edges summing up to the distance
+                double length = 0;
+                for (size_t k = 0; k + 1 < path.size(); k++) {
+                    if (!U.HasEdge(path[k], path[k + 1])) length = -1e18;
+                    std::vector<WeightedEdge> neighbours;
+                    U.GetNeighbours(path[k], neighbours);
+                    for (auto e : neighbours) {
+                        if (U.vertex_index->vertex_table[e.idx].node == path[k + 1]) length += e.weight;
+                    }
+                }
+                bool path_ok = dist[tidx] >= 1e9 ? path.empty() : (path.front() == sources[i] && path.back() == t && abs(length - res) < 1e-6);
+                if (abs(res - dist[tidx]) > 1e-6 || hop != expected_hop || !path_ok) {
+                    std::cout << "Shortest path wrong results detected. Distance from node " << sources[i] << " to node " << t << " is expected to be: " << dist[tidx] << " (" << expected_hop << " hops), actual: " << res << " (" << hop << " hops)" << std::endl;
+                    return 0;
+                }
+            }
+        }
+    }
+    std::cout << "Shortest path results verified!" << std::endl;
+
+    // Test incremental SSSP/BFS maintenance under update batches
+    std::cout << "Testing dynamic SSSP..." << std::endl;
+    {
+        // Symmetric weighted, symmetric unweighted, and directed weighted with a reverse graph
+        for (int mode = 0; mode < 3; mode++) {
+            bool symmetric = mode < 2, unweighted = mode == 1;
+            RadixGraph G(d, a, true, true), R(d, a, true, true);
+            auto insert = [&](int i) {
+                auto e = edges[i];
+                G.InsertEdge(e.first.first, e.first.second, e.second);
+                if (symmetric) G.InsertEdge(e.first.second, e.first.first, e.second);
+                else R.InsertEdge(e.first.second, e.first.first, e.second);
+            };
+            auto remove = [&](int i) {
+                auto e = edges[i].first;
+                G.DeleteEdge(e.first, e.second);
+                if (symmetric) G.DeleteEdge(e.second, e.first);
+                else R.DeleteEdge(e.second, e.first);
+            };
+            for (int i = 0; i < 30000; i++) insert(i);
+            NodeID source = edges[0].first.first;
+            DynamicSSSP dsssp(&G, source, symmetric ? nullptr : &R, unweighted);
+            for (int batch = 0; batch < 4; batch++) {
+                std::vector<EdgeUpdate> updates;
+                for (int i = 0; i < 300; i++) {
+                    int j = (batch * 300 + i) * 23 % 30000;
+                    remove(j);
+                    updates.push_back({(NodeID)edges[j].first.first, (NodeID)edges[j].first.second, 1, true});
+                    int k = 30000 + batch * 300 + i;
+                    insert(k);
+                    updates.push_back({(NodeID)edges[k].first.first, (NodeID)edges[k].first.second, edges[k].second, false});
+                }
+                dsssp.Update(updates);
+                int num_nodes = G.vertex_index->cnt;
+                std::vector<double> expected(num_nodes, kDistInf);
+                if (unweighted) {
+                    std::queue<int> Q;
+                    int s = G.vertex_index->RetrieveVertex(source)->idx;
+                    expected[s] = 0;
+                    Q.push(s);
+                    while (!Q.empty()) {
+                        int u = Q.front();
+                        Q.pop();
+                        std::vector<WeightedEdge> neighbours;
+                        G.GetNeighboursByOffset(u, neighbours);
+                        for (auto e : neighbours) {
+                            if (expected[e.idx] == kDistInf) expected[e.idx] = expected[u] + 1, Q.push(e.idx);
+                        }
+                    }
+                }
+                else {
+                    long num_edges = 1;
+                    for (int i = 0; i < num_nodes; i++) num_edges += G.degree[i];
+                    auto res = DeltaStep(&G, source, 2.0, num_nodes, num_edges);
+                    for (int i = 0; i < num_nodes; i++) expected[i] = res[i];
+                }
+                for (int v = 0; v < num_nodes; v++) {
+                    bool reachable = expected[v] < kDistInf;
+                    if (abs(expected[v] - dsssp.dist[v]) > 1e-4 * std::max(1.0, expected[v]) || reachable != (dsssp.parent[v] != -1)) {
+                        std::cout << "Dynamic SSSP wrong results detected. Distance of node " << G.vertex_index->vertex_table[v].node << " is expected to be: " << expected[v] << ", actual: " << dsssp.dist[v] << std::endl;
+                        return 0;
+                    }
+                }
+            }
+        }
+    }
+    std::cout << "Dynamic SSSP results verified!" << std::endl;
+
+    // Test the landmark distance oracle
+    std::cout << "Testing distance oracle..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true), R(d, a, true, true);
+        for (int i = 0; i < 40000; i++) {
+            auto e = edges[i];
+            U.InsertEdge(e.first.first, e.first.second, e.second);
+            R.InsertEdge(e.first.second, e.first.first, e.second);
+        }
+        DistanceOracle hops(&U, 8, &R, 100), dists(&U, 8, &R, 100, true);
+        for (int round = 0; round < 2; round++) {
+            for (int i = 0; i < 20; i++) {
+                NodeID s = edges[i * 37].first.first;
+                if (i < 2) s = U.vertex_index->vertex_table[hops.Landmarks()[i]].node;
+                for (int j = 0; j < 50; j++) {
+                    NodeID t = edges[j * 101 + i].first.second;
+                    double expected_hop = U.ShortestPath(s, t, nullptr, &R, true), expected = U.ShortestPath(s, t, nullptr, &R);
+                    auto hop_bounds = hops.Bounds(s, t), bounds = dists.Bounds(s, t);
+                    // Distances from a landmark are exact
+                    bool exact = i >= 2 || (hop_bounds.second == expected_hop && abs(bounds.second - expected) < 1e-4);
+                    if (hop_bounds.first > expected_hop || hop_bounds.second < expected_hop || bounds.first > expected + 1e-4 || bounds.second < expected - 1e-4 || !exact) {
+                        std::cout << "Distance oracle wrong results detected. Distance from node " << s << " to node " << t << " is expected to be: " << expected << " (" << expected_hop << " hops), actual bounds: [" << bounds.first << ", " << bounds.second << "] ([" << hop_bounds.first << ", " << hop_bounds.second << "] hops)" << std::endl;
+                        return 0;
+                    }
+                }
+            }
+            // Update edges; the oracles refresh on their next query
+            for (int i = 40000; i < 40200; i++) {
+                auto e = edges[i];
+                U.InsertEdge(e.first.first, e.first.second, e.second);
+                R.InsertEdge(e.first.second, e.first.first, e.second);
+                hops.Notify();
+                dists.Notify();
+            }
+        }
+    }
+    std::cout << "Distance oracle results verified!" << std::endl;
+
+    // Test k-core decomposition
+    std::cout << "Testing k-core..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        insert_symmetric(U, 60000);
+        DynamicKCore kc(&U, U.vertex_index->cnt);
+        for (int i = 60000; i < 62000; i++) {
+            auto e = edges[i].first;
+            kc.InsertEdge(e.first, e.second, 0.5);
+        }
+        // Sequential peeling: repeatedly remove a vertex of minimum degree
+        int num_nodes = U.vertex_index->cnt;
+        std::vector<int> deg(num_nodes), expected(num_nodes);
+        std::vector<bool> removed(num_nodes, false);
+        std::set<std::pair<int, int>> Q;
+        for (int i = 0; i < num_nodes; i++) {
+            std::vector<WeightedEdge> neighbours;
+            U.GetNeighboursByOffset(i, neighbours);
+            for (auto e : neighbours) deg[i] += e.idx != i;
+            Q.emplace(deg[i], i);
+        }
+        int k = 0;
+        while (!Q.empty()) {
+            auto [dv, v] = *Q.begin();
+            Q.erase(Q.begin());
+            k = std::max(k, dv);
+            expected[v] = k;
+            removed[v] = true;
+            std::vector<WeightedEdge> neighbours;
+            U.GetNeighboursByOffset(v, neighbours);
+            for (auto e : neighbours) {
+                if (removed[e.idx]) continue;
+                Q.erase({deg[e.idx], e.idx});
+                Q.emplace(--deg[e.idx], e.idx);
+            }
+        }
+        auto core = KCore(&U, num_nodes);
+        for (int i = 0; i < num_nodes; i++) {
+            if (expected[i] != core[i] || expected[i] != kc.core[i]) {
+                std::cout << "k-core wrong results detected. Core number of node " << U.vertex_index->vertex_table[i].node << " is expected to be: " << expected[i] << ", actual: " << core[i] << " (static), " << kc.core[i] << " (dynamic)" << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "k-core results verified!" << std::endl;
+
+    // Test label propagation on planted communities (cliques of 20 vertices with a few edges in between)
+    std::cout << "Testing label propagation..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        const int num_cliques = 100, clique_size = 20;
+        auto add_edge = [&](int i, int j) {
+            U.InsertEdge(vertex_ids[i], vertex_ids[j], 0.5);
+            U.InsertEdge(vertex_ids[j], vertex_ids[i], 0.5);
+        };
+        for (int c = 0; c < num_cliques; c++) {
+            for (int i = 0; i < clique_size; i++) {
+                for (int j = i + 1; j < clique_size; j++) add_edge(c * clique_size + i, c * clique_size + j);
+            }
+        }
+        for (int c = 0; c < num_cliques; c++) add_edge(c * clique_size, ((c + 1) % num_cliques) * clique_size + 1);
+        int num_nodes = U.vertex_index->cnt;
+        // Every label must be among the most frequent labels of its neighbours
+        auto stable = [&](pvector<NodeID>& labels) {
+            for (int v = 0; v < num_nodes; v++) {
+                std::vector<WeightedEdge> neighbours;
+                U.GetNeighboursByOffset(v, neighbours);
+                std::map<NodeID, int> count;
+                int best = 0;
+                for (auto e : neighbours) best = std::max(best, ++count[labels[e.idx]]);
+                if (!neighbours.empty() && count[labels[v]] != best) return false;
+            }
+            return true;
+        };
+        auto labels = LabelPropagation(&U, num_nodes, 100);
+        bool ok = stable(labels);
+        for (int i = 0; i < num_cliques * clique_size; i++) {
+            int v = U.vertex_index->RetrieveVertex(vertex_ids[i])->idx, first = U.vertex_index->RetrieveVertex(vertex_ids[i / clique_size * clique_size])->idx;
+            if (labels[v] != labels[first]) ok = false;
+        }
+        // Join the first two cliques and resume from the endpoints of the new edges
+        std::vector<int> active;
+        for (int i = 0; i < clique_size; i++) {
+            for (int j = clique_size; j < 2 * clique_size; j++) {
+                add_edge(i, j);
+                active.push_back(U.vertex_index->RetrieveVertex(vertex_ids[i])->idx);
+                active.push_back(U.vertex_index->RetrieveVertex(vertex_ids[j])->idx);
+            }
+        }
+        int rounds = LabelPropagation(&U, num_nodes, labels, active, 100);
+        int a0 = U.vertex_index->RetrieveVertex(vertex_ids[0])->idx, a1 = U.vertex_index->RetrieveVertex(vertex_ids[clique_size])->idx;
+        if (!ok || rounds >= 100 || !stable(labels) || labels[a0] != labels[a1]) {
+            std::cout << "Label propagation wrong results detected. Communities are not stable." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "Label propagation results verified!" << std::endl;
+
+    // Test neighbour sampling and random walks
+    std::cout << "Testing random walks..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        for (int i = 0; i < 40000; i++) {
+            auto e = edges[i];
+            U.InsertEdge(e.first.first, e.first.second, e.second);
+        }
+        // A hub with weights 1, 2, ..., 8, half of its edges frozen by compaction
+        NodeID hub = vertex_ids[0];
+        for (int i = 1; i <= 4; i++) U.InsertEdge(hub, vertex_ids[i], i);
+        U.Compact();
+        for (int i = 5; i <= 8; i++) U.InsertEdge(hub, vertex_ids[i], i);
+        std::mt19937_64 rng(7);
+        std::map<uint64_t, int> freq;
+        int num_samples = 36000;
+        WeightedEdge e;
+        for (int i = 0; i < num_samples; i++) {
+            U.GetRandomNeighbour(hub, rng, e, true);
+            freq[U.vertex_index->vertex_table[e.idx].node]++;
+        }
+        bool ok = true;
+        double total = 0;
+        std::vector<WeightedEdge> hub_edges;
+        U.GetNeighbours(hub, hub_edges);
+        for (auto x : hub_edges) total += x.weight;
+        for (auto x : hub_edges) {
+            double expected = num_samples * x.weight / total;
+            if (abs(freq[U.vertex_index->vertex_table[x.idx].node] - expected) > 5 * sqrt(expected) + 1) ok = false;
+        }
+        if (freq.size() > hub_edges.size()) ok = false;
+
+        // Deletions leave stale logs, so these walkers sample from their cached lists
+        for (int i = 0; i < 40000; i += 4) U.DeleteEdge(edges[i].first.first, edges[i].first.second);
+        int num_nodes = U.vertex_index->cnt;
+        WalkOptions opt;
+        opt.walk_length = 10;
+        opt.walks_per_vertex = 2;
+        opt.p = 0.5;
+        opt.q = 2;
+        opt.weighted = true;
+        auto walks = RandomWalks(&U, num_nodes, opt);
+        int num_threads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        auto walks_single = RandomWalks(&U, num_nodes, opt);
+        omp_set_num_threads(num_threads);
+        if (walks != walks_single || walks.size() != (size_t)num_nodes * 2 * 10) ok = false;
+        for (size_t i = 0; i + 1 < walks.size() && ok; i++) {
+            if (i % 10 == 9 || walks[i + 1] == kWalkEnd) continue;
+            if (!U.HasEdge(walks[i], walks[i + 1])) ok = false;
+        }
+        std::string path = "/tmp/radixgraph_walks.txt";
+        if (!RandomWalksToFile(&U, num_nodes, opt, path)) ok = false;
+        std::ifstream fin(path);
+        std::string line;
+        size_t num_lines = 0;
+        while (std::getline(fin, line)) {
+            uint64_t first = std::stoull(line.substr(0, line.find(' ')));
+            if (first != walks[num_lines * 10]) ok = false;
+            num_lines++;
+        }
+        std::remove(path.c_str());
+        if (!ok || num_lines != (size_t)num_nodes * 2) {
+            std::cout << "Random walk wrong results detected." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "Random walk results verified!" << std::endl;
+
+    // Test the EdgeMap engine with a BFS in every direction mode
+    std::cout << "Testing EdgeMap..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        insert_symmetric(U, 40000);
+        int num_nodes = U.vertex_index->cnt;
+        int64_t num_edges = 0;
+        for (int i = 0; i < num_nodes; i++) num_edges += U.degree[i];
+        int s = U.vertex_index->RetrieveVertex(edges[0].first.first)->idx;
+        std::vector<int> expected(num_nodes, -1);
+        std::queue<int> Q;
+        expected[s] = 0;
+        Q.push(s);
+        while (!Q.empty()) {
+            int u = Q.front();
+            Q.pop();
+            std::vector<WeightedEdge> neighbours;
+            U.GetNeighboursByOffset(u, neighbours);
+            for (auto e : neighbours) {
+                if (expected[e.idx] == -1) expected[e.idx] = expected[u] + 1, Q.push(e.idx);
+            }
+        }
+        struct BFSStep {
+            pvector<int>& parent;
+            bool update(int s, int d, EdgeWeight) {
+                if (parent[d] != -1) return false;
+                parent[d] = s;
+                return true;
+            }
+            bool updateAtomic(int s, int d, EdgeWeight) { return compare_and_swap(parent[d], -1, s); }
+            bool cond(int d) { return parent[d] == -1; }
+        };
+        // Default switching, always dense (pull and push), always sparse
+        std::vector<std::pair<bool, int64_t>> modes = {{true, -1}, {false, -1}, {true, 0}, {false, 0}, {false, INT64_MAX}};
+        for (auto [symmetric, threshold] : modes) {
+            pvector<int> parent(num_nodes, -1), level(num_nodes, -1);
+            BFSStep step{parent};
+            parent[s] = s;
+            level[s] = 0;
+            VertexSubset frontier(num_nodes, std::vector<int>{s});
+            for (int depth = 1; !frontier.empty(); depth++) {
+                frontier = EdgeMap(&U, frontier, step, num_edges, symmetric, threshold);
+                VertexMap(frontier, [&](int v) { level[v] = depth; });
+            }
+            for (int v = 0; v < num_nodes; v++) {
+                if (expected[v] != level[v]) {
+                    std::cout << "EdgeMap wrong results detected. Depth of node " << U.vertex_index->vertex_table[v].node << " is expected to be: " << expected[v] << ", actual: " << level[v] << std::endl;
+                    return 0;
+                }
+            }
+        }
+    }
+    std::cout << "EdgeMap results verified!" << std::endl;
+
+    // Test compaction
+    std::cout << "Testing compaction..." << std::endl;
+    std::vector<std::vector<WeightedEdge>> before(n);
+    #pragma omp parallel for
+    for (int i = 0; i < n; i++) {
+        G.GetNeighboursByOffset(i, before[i]);
+        std::sort(before[i].begin(), before[i].end(), [](WeightedEdge a, WeightedEdge b) {
+            return a.idx < b.idx;
+        });
+    }
+    G.Compact();
+    for (int i = 0; i < n; i++) {
+        std::vector<WeightedEdge> neighbours;
+        G.GetNeighboursByOffset(i, neighbours);
+        if (neighbours.size() != before[i].size()) {
+            std::cout << "Compaction wrong results detected. Expected size = " << before[i].size() << ", actual size = " << neighbours.size() << std::endl;
+            return 0;
+        }
+        for (size_t j = 0; j < neighbours.size(); j++) {
+            if (neighbours[j].idx != before[i][j].idx || neighbours[j].weight != before[i][j].weight) {
+                std::cout << "Compaction wrong results detected. Wrong neighbour of node " << G.vertex_index->vertex_table[i].node << std::endl;
+                return 0;
+            }
+        }
+    }
+    std::cout << "Compaction results verified!" << std::endl;
+
+    // Test filtered neighbour reads over compacted edges and logs
+    std::cout << "Testing filtered reads..." << std::endl;
+    {
+        RadixGraph U(d, a, true, true);
+        for (int i = 0; i < 40000; i++) {
+            auto e = edges[i].first;
+            U.InsertEdge(e.first, e.second, (i % 10) * 0.1 + 0.05);
+        }
+        // A hub whose compacted edges span several blocks
+        for (int i = 1; i <= 500; i++) U.InsertEdge(vertex_ids[0], vertex_ids[i], (i % 7) * 0.1 + 0.05);
+        U.Compact();
+        for (int i = 0; i < 10000; i++) {
+            auto e = edges[i * 4].first;
+            if (i % 2) U.DeleteEdge(e.first, e.second);
+            else U.InsertEdge(e.first, e.second, 0.95);
+        }
+        for (int i = 40000; i < 50000; i++) {
+            auto e = edges[i].first;
+            U.InsertEdge(e.first, e.second, (i % 10) * 0.1 + 0.05);
+        }
+        int num_nodes = U.vertex_index->cnt;
+        std::vector<uint64_t> even((num_nodes + 63) / 64, 0x5555555555555555ull);
+        std::vector<EdgeFilter> filters(3);
+        filters[0].min_weight = 0.3, filters[0].max_weight = 0.6;
+        filters[1].destinations = even.data();
+        filters[2].min_weight = 0.9, filters[2].destinations = even.data();
+        auto by_idx = [](WeightedEdge a, WeightedEdge b) { return a.idx < b.idx; };
+        bool ok = true;
+        std::vector<WeightedEdge> all, filtered;
+        for (int v = 0; v < num_nodes && ok; v++) {
+            U.GetNeighboursByOffset(v, all);
+            for (auto& filter : filters) {
+                std::vector<WeightedEdge> expected;
+                for (auto e : all) {
+                    if (filter.Match(e)) expected.push_back(e);
+                }
+                U.GetNeighboursByOffset(v, filtered, filter);
+                std::sort(expected.begin(), expected.end(), by_idx);
+                std::sort(filtered.begin(), filtered.end(), by_idx);
+                if (expected.size() != filtered.size()) ok = false;
+                for (size_t j = 0; ok && j < expected.size(); j++) {
+                    if (expected[j].idx != filtered[j].idx || expected[j].weight != filtered[j].weight) ok = false;
+                }
+            }
+        }
+        if (!ok) {
+            std::cout << "Filtered read wrong results detected." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "Filtered read results verified!" << std::endl;
+
+    // Test typed edges against one graph per type
+    std::cout << "Testing typed edges..." << std::endl;
+    {
+        int num_types = 3;
+        RadixGraph T(d, a, true, true, num_types);
+        std::vector<RadixGraph*> per_type;
+        for (int t = 0; t < num_types; t++) per_type.push_back(new RadixGraph(d, a, true, true));
+        // The same vertex pairs under several types
+        #pragma omp parallel for
+        for (int i = 0; i < 30000; i++) {
+            auto e = edges[i / 2].first;
+            EdgeType t = (i % 2) ? (i / 2) % num_types : ((i / 2) + 1) % num_types;
+            T.InsertEdge(e.first, e.second, 0.5 + t, t);
+            per_type[t]->InsertEdge(e.first, e.second, 0.5 + t);
+        }
+        T.Compact();
+        for (int i = 0; i < 6000; i++) {
+            auto e = edges[i * 2].first;
+            EdgeType t = i % num_types;
+            if (T.DeleteEdge(e.first, e.second, t) != per_type[t]->DeleteEdge(e.first, e.second)) {
+                std::cout << "Typed edge wrong results detected. Deletion of an edge of type " << (int)t << " disagrees." << std::endl;
+                return 0;
+            }
+        }
+        bool ok = true;
+        int num_nodes = T.vertex_index->cnt;
+        std::vector<WeightedEdge> neighbours, expected_neighbours;
+        for (int v = 0; v < num_nodes && ok; v++) {
+            NodeID id = T.vertex_index->vertex_table[v].node;
+            for (int t = 0; t < num_types && ok; t++) {
+                EdgeFilter filter;
+                filter.type = t;
+                T.GetNeighbours(id, neighbours, filter);
+                std::vector<std::pair<NodeID, double>> actual, expected;
+                for (auto e : neighbours) actual.emplace_back(T.vertex_index->vertex_table[e.idx].node, e.weight);
+                if (!per_type[t]->GetNeighbours(id, expected_neighbours)) expected_neighbours.clear();
+                for (auto e : expected_neighbours) expected.emplace_back(per_type[t]->vertex_index->vertex_table[e.idx].node, e.weight);
+                std::sort(actual.begin(), actual.end());
+                std::sort(expected.begin(), expected.end());
+                if (actual != expected) ok = false;
+                if (!expected.empty() && !T.HasEdge(id, expected[0].first, t)) ok = false;
+            }
+            // Untyped reads only see type 0
+            T.GetNeighboursByOffset(v, neighbours);
+            if (!per_type[0]->GetNeighbours(id, expected_neighbours)) expected_neighbours.clear();
+            if (neighbours.size() != expected_neighbours.size()) ok = false;
+        }
+        for (auto g : per_type) delete g;
+        if (!ok) {
+            std::cout << "Typed edge wrong results detected." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "Typed edge results verified!" << std::endl;
+
+    // Test upsert
+    std::cout << "Testing upsert..." << std::endl;
+    RadixGraph H(d, a, true, true);
+    for (int i = 0; i < 1000; i++) {
+        auto e = edges[i];
+        H.InsertEdge(e.first.first, e.first.second, e.second);
+        H.InsertEdge(e.first.first, e.first.second, e.second + 1);
+    }
+    for (int i = 0; i < 500; i++) {
+        auto e = edges[i];
+        H.DeleteEdge(e.first.first, e.first.second);
+        H.DeleteEdge(e.first.first, e.first.second);
+    }
+    int num_live = 0;
+    for (int i = 0; i < H.vertex_index->cnt; i++) {
+        std::vector<WeightedEdge> neighbours;
+        H.GetNeighboursByOffset(i, neighbours);
+        if (neighbours.size() != (size_t)H.degree[i]) {
+            std::cout << "Upsert wrong results detected. Degree of node " << H.vertex_index->vertex_table[i].node << " is expected to be: " << neighbours.size() << ", actual: " << H.degree[i] << std::endl;
+            return 0;
+        }
+        for (auto e : neighbours) {
+            if (e.weight != MakeEdge(e.idx, 1.5).weight) {
+                std::cout << "Upsert wrong results detected. Duplicate insert was not turned into an update." << std::endl;
+                return 0;
+            }
+        }
+        num_live += neighbours.size();
+    }
+    if (num_live != 500) {
+        std::cout << "Upsert wrong results detected. Expected edges = 500, actual edges = " << num_live << std::endl;
+        return 0;
+    }
+    std::cout << "Upsert results verified!" << std::endl;
+
+    // Test concurrent upsert: threads race on the same pairs, including the long log of a hub
+    std::cout << "Testing concurrent upsert..." << std::endl;
+    {
+        RadixGraph K(d, a, true, true);
+        std::vector<std::pair<NodeID, NodeID>> pairs, deleted;
+        for (int i = 0; i < 2000; i++) pairs.push_back({(NodeID)edges[0].first.first, (NodeID)edges[i].first.second});
+        for (int i = 2000; i < 4000; i++) pairs.push_back({(NodeID)edges[i].first.first, (NodeID)edges[i].first.second});
+        for (int i = 0; i < (int)pairs.size(); i += 3) deleted.push_back(pairs[i]);
+        std::set<std::pair<NodeID, NodeID>> expected(pairs.begin(), pairs.end());
+        for (auto p : deleted) expected.erase(p);
+        auto race = [&](const std::vector<std::pair<NodeID, NodeID>> &ops, bool del) {
+            std::vector<std::thread> writers;
+            for (int t = 0; t < 8; t++) {
+                writers.emplace_back([&, t]() {
+                    for (int j = 0; j < (int)ops.size(); j++) {
+                        auto p = ops[(j + t * 97) % ops.size()];
+                        if (del) K.DeleteEdge(p.first, p.second);
+                        else K.InsertEdge(p.first, p.second, 0.5);
+                    }
+                });
+            }
+            for (auto& t : writers) t.join();
+        };
+        race(pairs, false);
+        race(deleted, true);
+        race(deleted, false);
+        race(deleted, true);
+        size_t num_live = 0;
+        bool ok = true;
+        for (int i = 0; i < K.vertex_index->cnt; i++) {
+            std::vector<WeightedEdge> neighbours;
+            K.GetNeighboursByOffset(i, neighbours);
+            std::set<int> distinct;
+            for (auto e : neighbours) distinct.insert(e.idx);
+            if (distinct.size() != neighbours.size() || neighbours.size() != (size_t)K.degree[i] || neighbours.size() != (size_t)K.vertex_index->vertex_table[i].deg) ok = false;
+            num_live += neighbours.size();
+        }
+        if (!ok || num_live != expected.size()) {
+            std::cout << "Concurrent upsert wrong results detected. Expected edges = " << expected.size() << ", actual edges = " << num_live << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "Concurrent upsert results verified!" << std::endl;
+
+    // Test deduplication of hub logs, which are longer than DedupScratch::kHashLimit and use the bitmap
+    std::cout << "Testing hub deduplication..." << std::endl;
+    {
+        RadixGraph D(d, a, true, true);
+        uint64_t hub = vertex_ids[0];
+        std::map<uint64_t, double> expected;
+        auto check = [&]() {
+            for (int round = 0; round < 2; round++) {
+                std::vector<WeightedEdge> neighbours;
+                D.GetNeighbours(hub, neighbours);
+                std::map<uint64_t, double> actual;
+                for (auto e : neighbours) {
+                    if (!actual.emplace(D.vertex_index->vertex_table[e.idx].node, e.weight).second) return false;
+                }
+                if (actual.size() != expected.size()) return false;
+                for (auto [id, w] : expected) {
+                    if (!actual.count(id) || actual[id] != MakeEdge(0, w).weight) return false;
+                }
+            }
+            return true;
+        };
+        // Interleave inserts, overwrites, deletes and re-inserts until the log exceeds kHashLimit
+        auto churn = [&](int first, int last) {
+            for (int j = first; j < last; j++) {
+                uint64_t v = vertex_ids[j];
+                D.InsertEdge(hub, v, 0.5), expected[v] = 0.5;
+                if (j % 3 == 0) D.InsertEdge(hub, v, 1.0), expected[v] = 1.0;
+                if (j % 5 == 0) D.DeleteEdge(hub, v), expected.erase(v);
+                if (j % 10 == 0) D.InsertEdge(hub, v, 2.0), expected[v] = 2.0;
+                if (j % 7 == 0) {
+                    uint64_t u = vertex_ids[first + (j - first) / 2];
+                    if (D.DeleteEdge(hub, u)) expected.erase(u);
+                }
+            }
+        };
+        churn(1, 3001);
+        bool ok = check();
+        // Logs on top of a frozen snapshot: the bitmap also hides stale frozen edges
+        D.Compact();
+        churn(1501, 4501);
+        ok = ok && check();
+        if (!ok || D.degree[D.vertex_index->RetrieveVertex(hub)->idx] != (int)expected.size()) {
+            std::cout << "Hub deduplication wrong results detected." << std::endl;
+            return 0;
+        }
+    }
+    std::cout << "Hub deduplication results verified!" << std::endl;
+
+    // Test reads from threads outside of OpenMP
+    std::cout << "Testing std::thread reads..." << std::endl;
+    std::atomic<int> num_wrong = 0;
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; t++) {
+        readers.emplace_back([&]() {
+            for (int i = 0; i < H.vertex_index->cnt; i++) {
+                std::vector<WeightedEdge> neighbours;
+                H.GetNeighboursByOffset(i, neighbours);
+                if (neighbours.size() != (size_t)H.degree[i]) num_wrong++;
+            }
+        });
+    }
+    for (auto& t : readers) t.join();
+    if (num_wrong > 0) {
+        std::cout << "std::thread reads wrong results detected. " << num_wrong << " wrong neighbour lists." << std::endl;
+        return 0;
+    }
+    std::cout << "std::thread reads verified!" << std::endl;
+
     return 0;
 }
\ No newline at end of file